@@ -1,4 +1,12 @@
+#include <algorithm>
+#include <array>
+#include <mutex>
 #include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <benchmark/benchmark.h>
 
@@ -31,6 +39,521 @@ static void BM_sort(benchmark::State& state) {
 
 BENCHMARK(BM_sort);
 
+// input shapes for the sort matrix
+enum class SortPattern { Random, Sorted, Reversed, OrganPipe, FewUnique };
+
+static std::vector<int> make_sort_input(SortPattern pattern, int size) {
+  std::mt19937 gen(1234);
+  std::vector<int> vec(size);
+  for (int i = 0; i < size; i++) {
+    switch (pattern) {
+      case SortPattern::Random:    vec[i] = static_cast<int>(gen()); break;
+      case SortPattern::Sorted:    vec[i] = i; break;
+      case SortPattern::Reversed:  vec[i] = size - i; break;
+      case SortPattern::OrganPipe: vec[i] = std::min(i, size - i); break;
+      case SortPattern::FewUnique: vec[i] = static_cast<int>(gen() % 16); break;
+    }
+  }
+  return vec;
+}
+
+template <SortPattern Pattern>
+static void BM_MrSort(benchmark::State &state) {
+  const auto input = make_sort_input(Pattern, state.range(0));
+  std::vector<int> vec;
+  for (auto _ : state) {
+    vec = input;
+    mr::sort(vec);
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <SortPattern Pattern>
+static void BM_StdSort(benchmark::State &state) {
+  const auto input = make_sort_input(Pattern, state.range(0));
+  std::vector<int> vec;
+  for (auto _ : state) {
+    vec = input;
+    std::sort(vec.begin(), vec.end());
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define MR_SORT_MATRIX(pattern) \
+  BENCHMARK_TEMPLATE(BM_MrSort, SortPattern::pattern)->RangeMultiplier(16)->Range(1 << 8, 1 << 20); \
+  BENCHMARK_TEMPLATE(BM_StdSort, SortPattern::pattern)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)
+
+MR_SORT_MATRIX(Random);
+MR_SORT_MATRIX(Sorted);
+MR_SORT_MATRIX(Reversed);
+MR_SORT_MATRIX(OrganPipe);
+MR_SORT_MATRIX(FewUnique);
+
+template <typename T>
+static void BM_RadixSort(benchmark::State &state) {
+  std::mt19937_64 gen(42);
+  std::vector<T> input(state.range(0));
+  for (auto &x : input) {
+    x = static_cast<T>(gen());
+  }
+  std::vector<T> vec;
+  for (auto _ : state) {
+    vec = input;
+    mr::radix_sort(vec);
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+static void BM_StdSortKeys(benchmark::State &state) {
+  std::mt19937_64 gen(42);
+  std::vector<T> input(state.range(0));
+  for (auto &x : input) {
+    x = static_cast<T>(gen());
+  }
+  std::vector<T> vec;
+  for (auto _ : state) {
+    vec = input;
+    std::sort(vec.begin(), vec.end());
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_RadixSort, std::uint32_t)->RangeMultiplier(16)->Range(1 << 8, 1 << 24);
+BENCHMARK_TEMPLATE(BM_StdSortKeys, std::uint32_t)->RangeMultiplier(16)->Range(1 << 8, 1 << 24);
+BENCHMARK_TEMPLATE(BM_RadixSort, std::uint64_t)->RangeMultiplier(16)->Range(1 << 8, 1 << 24);
+BENCHMARK_TEMPLATE(BM_StdSortKeys, std::uint64_t)->RangeMultiplier(16)->Range(1 << 8, 1 << 24);
+BENCHMARK_TEMPLATE(BM_RadixSort, float)->RangeMultiplier(16)->Range(1 << 8, 1 << 24);
+BENCHMARK_TEMPLATE(BM_StdSortKeys, float)->RangeMultiplier(16)->Range(1 << 8, 1 << 24);
+
+// sorts consecutive batches of N keys, the shape of introsort's leaves
+template <std::size_t N>
+static void BM_SortSmallNetwork(benchmark::State &state) {
+  std::mt19937 gen(42);
+  std::vector<int> input(N * 1024);
+  for (auto &x : input) {
+    x = static_cast<int>(gen());
+  }
+  std::vector<int> vec;
+  for (auto _ : state) {
+    vec = input;
+    for (std::size_t i = 0; i < vec.size(); i += N) {
+      mr::sort_small<N>(vec.begin() + i);
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+template <std::size_t N>
+static void BM_SortSmallInsertion(benchmark::State &state) {
+  std::mt19937 gen(42);
+  std::vector<int> input(N * 1024);
+  for (auto &x : input) {
+    x = static_cast<int>(gen());
+  }
+  std::vector<int> vec;
+  for (auto _ : state) {
+    vec = input;
+    for (std::size_t i = 0; i < vec.size(); i += N) {
+      mr::insertion_sort(vec.begin() + i, vec.begin() + i + N);
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+BENCHMARK_TEMPLATE(BM_SortSmallNetwork, 4);
+BENCHMARK_TEMPLATE(BM_SortSmallInsertion, 4);
+BENCHMARK_TEMPLATE(BM_SortSmallNetwork, 8);
+BENCHMARK_TEMPLATE(BM_SortSmallInsertion, 8);
+BENCHMARK_TEMPLATE(BM_SortSmallNetwork, 16);
+BENCHMARK_TEMPLATE(BM_SortSmallInsertion, 16);
+BENCHMARK_TEMPLATE(BM_SortSmallNetwork, 24);
+BENCHMARK_TEMPLATE(BM_SortSmallInsertion, 24);
+BENCHMARK_TEMPLATE(BM_SortSmallNetwork, 32);
+BENCHMARK_TEMPLATE(BM_SortSmallInsertion, 32);
+
+struct TimedEvent {
+  std::int64_t timestamp;
+  std::int64_t payload;
+};
+
+// timestamps in order except for a fraction of late arrivals
+static std::vector<TimedEvent> make_events(std::int64_t size, int late_percent) {
+  std::mt19937_64 gen(7);
+  std::vector<TimedEvent> events(size);
+  for (std::int64_t i = 0; i < size; i++) {
+    events[i] = {i * 10, i};
+    if (static_cast<int>(gen() % 100) < late_percent) {
+      events[i].timestamp -= static_cast<std::int64_t>(gen() % 1000);
+    }
+  }
+  return events;
+}
+
+static void BM_StableSortEvents(benchmark::State &state) {
+  const auto input = make_events(state.range(0), state.range(1));
+  mr::Vector<TimedEvent> scratch;
+  std::vector<TimedEvent> events;
+  for (auto _ : state) {
+    events = input;
+    mr::stable_sort(events, scratch, std::less<>{}, &TimedEvent::timestamp);
+    benchmark::DoNotOptimize(events.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_StdStableSortEvents(benchmark::State &state) {
+  const auto input = make_events(state.range(0), state.range(1));
+  std::vector<TimedEvent> events;
+  for (auto _ : state) {
+    events = input;
+    std::stable_sort(events.begin(), events.end(),
+      [](const TimedEvent &a, const TimedEvent &b) { return a.timestamp < b.timestamp; });
+    benchmark::DoNotOptimize(events.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_StableSortEvents)->ArgsProduct({{1 << 16, 1 << 20}, {0, 1, 10, 100}});
+BENCHMARK(BM_StdStableSortEvents)->ArgsProduct({{1 << 16, 1 << 20}, {0, 1, 10, 100}});
+
+// p99 of a batch of request latencies
+static std::vector<double> make_latencies(std::int64_t size) {
+  std::mt19937_64 gen(3);
+  std::lognormal_distribution<double> dist(3.0, 1.0);
+  std::vector<double> latencies(size);
+  for (auto &x : latencies) {
+    x = dist(gen);
+  }
+  return latencies;
+}
+
+static void BM_PercentileSort(benchmark::State &state) {
+  const auto input = make_latencies(state.range(0));
+  std::vector<double> vec;
+  for (auto _ : state) {
+    vec = input;
+    mr::sort(vec);
+    benchmark::DoNotOptimize(vec[vec.size() * 99 / 100]);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_PercentileNthElement(benchmark::State &state) {
+  const auto input = make_latencies(state.range(0));
+  std::vector<double> vec;
+  for (auto _ : state) {
+    vec = input;
+    mr::nth_element(vec, vec.begin() + vec.size() * 99 / 100);
+    benchmark::DoNotOptimize(vec[vec.size() * 99 / 100]);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_PercentileStdNthElement(benchmark::State &state) {
+  const auto input = make_latencies(state.range(0));
+  std::vector<double> vec;
+  for (auto _ : state) {
+    vec = input;
+    std::nth_element(vec.begin(), vec.begin() + vec.size() * 99 / 100, vec.end());
+    benchmark::DoNotOptimize(vec[vec.size() * 99 / 100]);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_PercentileSort)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_PercentileNthElement)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_PercentileStdNthElement)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+// slowest 1% of the batch, slowest first
+static void BM_TopK(benchmark::State &state) {
+  const auto input = make_latencies(state.range(0));
+  for (auto _ : state) {
+    auto top = mr::top_k(input, input.size() / 100);
+    benchmark::DoNotOptimize(top.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_TopKPartialSort(benchmark::State &state) {
+  const auto input = make_latencies(state.range(0));
+  std::vector<double> vec;
+  for (auto _ : state) {
+    vec = input;
+    mr::partial_sort(vec, vec.begin() + vec.size() / 100, std::greater<>{});
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_TopKStdPartialSort(benchmark::State &state) {
+  const auto input = make_latencies(state.range(0));
+  std::vector<double> vec;
+  for (auto _ : state) {
+    vec = input;
+    std::partial_sort(vec.begin(), vec.begin() + vec.size() / 100, vec.end(), std::greater<>{});
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TopK)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_TopKPartialSort)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK(BM_TopKStdPartialSort)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+// range(0): elements, range(1): threads (the caller counts as one)
+template <typename T>
+static void BM_ParallelSort(benchmark::State &state) {
+  std::mt19937_64 gen(42);
+  mr::Vector<T> input;
+  input.reserve(state.range(0));
+  for (std::int64_t i = 0; i < state.range(0); i++) {
+    input.emplace_back(static_cast<T>(gen() % (1ull << 40)));
+  }
+  mr::ThreadPool pool(state.range(1) - 1);
+  mr::Vector<T> vec;
+  for (auto _ : state) {
+    state.PauseTiming();
+    vec = input;
+    state.ResumeTiming();
+    mr::sort(mr::par.on(pool), vec);
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void parallel_sort_args(benchmark::internal::Benchmark *bench) {
+  const std::int64_t cores = std::max(1u, std::thread::hardware_concurrency());
+  for (std::int64_t size = 100'000; size <= 100'000'000; size *= 10) {
+    for (std::int64_t threads = 1; threads < cores; threads *= 2) {
+      bench->Args({size, threads});
+    }
+    bench->Args({size, cores});
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_ParallelSort, int)->Apply(parallel_sort_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelSort, double)->Apply(parallel_sort_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// range(0): key length in bytes
+static void BM_StringHash(benchmark::State &state) {
+  const std::string key(state.range(0), 'k');
+  mr::String<>::Hash hash;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hash(std::string_view(key)));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_StdStringHash(benchmark::State &state) {
+  const std::string key(state.range(0), 'k');
+  std::hash<std::string_view> hash;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hash(std::string_view(key)));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_StringHash)->RangeMultiplier(4)->Range(4, 1 << 16);
+BENCHMARK(BM_StdStringHash)->RangeMultiplier(4)->Range(4, 1 << 16);
+
+using BenchHashMap = mr::HashMap<std::uint64_t, std::uint64_t>;
+using BenchUnorderedMap = std::unordered_map<std::uint64_t, std::uint64_t>;
+using BenchStaticHashmap = mr::StaticHashmap<std::uint64_t, std::uint64_t>;
+
+static std::vector<std::uint64_t> make_keys(std::int64_t size, std::uint64_t seed) {
+  std::mt19937_64 gen(seed);
+  std::vector<std::uint64_t> keys(size);
+  for (auto &key : keys) {
+    key = gen();
+  }
+  return keys;
+}
+
+static void bench_insert(BenchHashMap &map, std::uint64_t key) { map.try_emplace(key, key); }
+static void bench_insert(BenchUnorderedMap &map, std::uint64_t key) { map.try_emplace(key, key); }
+static void bench_insert(BenchStaticHashmap &map, std::uint64_t key) { map.emplace(key, key); }
+
+static bool bench_contains(BenchHashMap &map, std::uint64_t key) { return map.find(key) != nullptr; }
+static bool bench_contains(BenchUnorderedMap &map, std::uint64_t key) { return map.find(key) != map.end(); }
+static bool bench_contains(BenchStaticHashmap &map, std::uint64_t key) { return map.find(key).has_value(); }
+
+// range(0): keys; StaticHashmap holds at most 1024 of them
+template <typename Map>
+static void BM_MapInsert(benchmark::State &state) {
+  const auto keys = make_keys(state.range(0), 1);
+  for (auto _ : state) {
+    auto map = std::make_unique<Map>();
+    for (auto key : keys) {
+      bench_insert(*map, key);
+    }
+    benchmark::DoNotOptimize(map.get());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// range(1): 1 looks up inserted keys, 0 keys that are not in the map
+template <typename Map>
+static void BM_MapFind(benchmark::State &state) {
+  auto keys = make_keys(state.range(0), 1);
+  auto map = std::make_unique<Map>();
+  for (auto key : keys) {
+    bench_insert(*map, key);
+  }
+  if (state.range(1) == 0) {
+    keys = make_keys(state.range(0), 2);
+  } else {
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(3));
+  }
+  for (auto _ : state) {
+    std::size_t found = 0;
+    for (auto key : keys) {
+      found += bench_contains(*map, key);
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// 900 string keys in the 1024 slot table; range(0): 1 looks up inserted keys, 0 missing ones
+static void BM_StaticHashmapStringFind(benchmark::State &state) {
+  auto make_string_keys = [](std::uint64_t seed) {
+    std::vector<std::string> keys;
+    for (auto key : make_keys(900, seed)) {
+      keys.push_back("user/session/" + std::to_string(key));
+    }
+    return keys;
+  };
+  auto keys = make_string_keys(1);
+  auto map = std::make_unique<mr::StaticHashmap<std::string, int>>();
+  for (std::size_t i = 0; i < keys.size(); i++) {
+    map->emplace(keys[i], static_cast<int>(i));
+  }
+  if (state.range(0) == 0) {
+    keys = make_string_keys(2);
+  }
+  for (auto _ : state) {
+    std::size_t found = 0;
+    for (const auto &key : keys) {
+      found += map->contains(key);
+    }
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+BENCHMARK(BM_StaticHashmapStringFind)->Arg(0)->Arg(1);
+
+// keyword recognition in a token stream: 32 keywords known at compile time,
+// half of the looked up identifiers are keywords
+static constexpr std::array<std::pair<std::string_view, int>, 32> bench_keywords {{
+  {"alignas", 0}, {"auto", 1}, {"bool", 2}, {"break", 3}, {"case", 4}, {"catch", 5}, {"char", 6},
+  {"class", 7}, {"const", 8}, {"constexpr", 9}, {"continue", 10}, {"default", 11}, {"delete", 12},
+  {"do", 13}, {"double", 14}, {"else", 15}, {"enum", 16}, {"explicit", 17}, {"false", 18},
+  {"float", 19}, {"for", 20}, {"if", 21}, {"inline", 22}, {"int", 23}, {"namespace", 24},
+  {"return", 25}, {"static", 26}, {"struct", 27}, {"template", 28}, {"true", 29}, {"using", 30},
+  {"while", 31},
+}};
+
+static std::vector<std::string> make_tokens() {
+  std::vector<std::string> tokens;
+  std::mt19937_64 rng(1);
+  for (int i = 0; i < 1024; i++) {
+    tokens.emplace_back(i % 2 == 0 ? std::string(bench_keywords[rng() % 32].first) : "ident_" + std::to_string(rng() % 1000));
+  }
+  return tokens;
+}
+
+template <typename Map>
+static void bench_keyword_lookup(benchmark::State &state, const Map &map) {
+  const auto tokens = make_tokens();
+  for (auto _ : state) {
+    int sum = 0;
+    for (const auto &token : tokens) {
+      if (auto it = map.find(std::string_view(token)); it != nullptr) {
+        sum += *it;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * tokens.size());
+}
+
+static void BM_PerfectHashMapKeywords(benchmark::State &state) {
+  static constexpr mr::PerfectHashMap map(bench_keywords);
+  bench_keyword_lookup(state, map);
+}
+
+static void BM_HashMapKeywords(benchmark::State &state) {
+  mr::HashMap<std::string_view, int> map;
+  for (auto [key, value] : bench_keywords) {
+    map.try_emplace(key, value);
+  }
+  bench_keyword_lookup(state, map);
+}
+
+static void BM_UnorderedMapKeywords(benchmark::State &state) {
+  const std::unordered_map<std::string_view, int> map(bench_keywords.begin(), bench_keywords.end());
+  const auto tokens = make_tokens();
+  for (auto _ : state) {
+    int sum = 0;
+    for (const auto &token : tokens) {
+      if (auto it = map.find(token); it != map.end()) {
+        sum += it->second;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * tokens.size());
+}
+
+BENCHMARK(BM_PerfectHashMapKeywords);
+BENCHMARK(BM_HashMapKeywords);
+BENCHMARK(BM_UnorderedMapKeywords);
+
+static void BM_HashMapErase(benchmark::State &state) {
+  const auto keys = make_keys(state.range(0), 1);
+  BenchHashMap map;
+  for (auto _ : state) {
+    for (auto key : keys) {
+      map.try_emplace(key, key);
+    }
+    for (auto key : keys) {
+      map.erase(key);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_UnorderedMapErase(benchmark::State &state) {
+  const auto keys = make_keys(state.range(0), 1);
+  BenchUnorderedMap map;
+  for (auto _ : state) {
+    for (auto key : keys) {
+      map.try_emplace(key, key);
+    }
+    for (auto key : keys) {
+      map.erase(key);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_MapInsert, BenchHashMap)->RangeMultiplier(10)->Range(1000, 10'000'000);
+BENCHMARK_TEMPLATE(BM_MapInsert, BenchUnorderedMap)->RangeMultiplier(10)->Range(1000, 10'000'000);
+BENCHMARK_TEMPLATE(BM_MapInsert, BenchStaticHashmap)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_MapFind, BenchHashMap)->ArgsProduct({{1000, 10'000, 100'000, 1'000'000, 10'000'000}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_MapFind, BenchUnorderedMap)->ArgsProduct({{1000, 10'000, 100'000, 1'000'000, 10'000'000}, {0, 1}});
+BENCHMARK_TEMPLATE(BM_MapFind, BenchStaticHashmap)->ArgsProduct({{1000}, {0, 1}});
+BENCHMARK(BM_HashMapErase)->RangeMultiplier(10)->Range(1000, 10'000'000);
+BENCHMARK(BM_UnorderedMapErase)->RangeMultiplier(10)->Range(1000, 10'000'000);
+
 static void BM_FindPath(benchmark::State &state) {
     mr::Graph<int> graph;
     const std::size_t num_nodes = state.range(0);
@@ -57,5 +580,617 @@ BENCHMARK(BM_FindPath)
     ->Range(8, 8 << 10) // Test with 8 to 8192 nodes
     ->Complexity();
 
+// 4 random out-edges per node: many converging paths, BFS stays O(V + E)
+static mr::Graph<int> make_random_graph(std::size_t num_nodes) {
+  mr::GraphBuilder<int> graph;
+  std::mt19937_64 rng(11);
+  for (std::size_t i = 0; i < num_nodes; ++i) {
+    graph.add_node(i);
+  }
+  for (std::size_t i = 0; i < num_nodes * 4; ++i) {
+    graph.add_edge(rng() % num_nodes, rng() % num_nodes);
+  }
+  return graph.build();
+}
+
+// side x side grid with edges to the 4 neighbours
+static mr::Graph<int> make_grid_graph(std::size_t side) {
+  mr::GraphBuilder<int> graph;
+  for (std::size_t i = 0; i < side * side; ++i) {
+    graph.add_node(i);
+  }
+  for (std::size_t row = 0; row < side; ++row) {
+    for (std::size_t col = 0; col < side; ++col) {
+      const std::size_t node = row * side + col;
+      if (col + 1 < side) graph.add_edge(node, node + 1).add_edge(node + 1, node);
+      if (row + 1 < side) graph.add_edge(node, node + side).add_edge(node + side, node);
+    }
+  }
+  return graph.build();
+}
+
+// range(0): nodes; queries between random pairs with one reused scratch
+static void BM_FindPathRandom(benchmark::State &state) {
+  const std::size_t num_nodes = state.range(0);
+  const auto graph = make_random_graph(num_nodes);
+  mr::PathScratch<> scratch;
+  std::mt19937_64 rng(5);
+  for (auto _ : state) {
+    auto path = graph.find_path(rng() % num_nodes, rng() % num_nodes, scratch);
+    benchmark::DoNotOptimize(path);
+  }
+  state.SetComplexityN(num_nodes);
+}
+
+static void BM_FindPathRandomBidirectional(benchmark::State &state) {
+  const std::size_t num_nodes = state.range(0);
+  const auto graph = make_random_graph(num_nodes);
+  const auto reversed = graph.transposed();
+  mr::PathScratch<> scratch;
+  std::mt19937_64 rng(5);
+  for (auto _ : state) {
+    auto path = graph.find_path_bidirectional(rng() % num_nodes, rng() % num_nodes, reversed, scratch);
+    benchmark::DoNotOptimize(path);
+  }
+  state.SetComplexityN(num_nodes);
+}
+
+// range(0): grid side; corner to corner
+static void BM_FindPathGrid(benchmark::State &state) {
+  const std::size_t side = state.range(0);
+  const auto graph = make_grid_graph(side);
+  mr::PathScratch<> scratch;
+  for (auto _ : state) {
+    auto path = graph.find_path(0, side * side - 1, scratch);
+    benchmark::DoNotOptimize(path);
+  }
+  state.SetComplexityN(side * side);
+}
+
+static void BM_FindPathGridDijkstra(benchmark::State &state) {
+  const std::size_t side = state.range(0);
+  const auto graph = make_grid_graph(side);
+  auto weight = [](std::size_t from, std::size_t to) { return (from * 31 + to * 17) % 16 + 1; };
+  mr::PathScratch<std::size_t> scratch;
+  for (auto _ : state) {
+    auto path = graph.find_path_weighted(0, side * side - 1, weight, scratch);
+    benchmark::DoNotOptimize(path);
+  }
+  state.SetComplexityN(side * side);
+}
+
+// the same weights stored in the edge property column vs a side map keyed by edge pair
+static std::uint32_t grid_weight(std::size_t from, std::size_t to) { return (from * 31 + to * 17) % 16 + 1; }
+
+static void BM_FindPathGridWeightColumn(benchmark::State &state) {
+  const std::size_t side = state.range(0);
+  const auto plain = make_grid_graph(side);
+  mr::GraphBuilder<int, std::uint32_t> builder;
+  for (std::size_t node = 0; node < side * side; ++node) {
+    builder.add_node(node);
+    const auto children = *plain.node_children(node);
+    for (std::size_t child : children) {
+      builder.add_edge(node, child, grid_weight(node, child));
+    }
+  }
+  const auto graph = builder.build();
+  mr::PathScratch<std::size_t> scratch;
+  for (auto _ : state) {
+    auto path = graph.find_path_weighted(0, side * side - 1, scratch);
+    benchmark::DoNotOptimize(path);
+  }
+  state.SetComplexityN(side * side);
+}
+
+static void BM_FindPathGridWeightSideMap(benchmark::State &state) {
+  const std::size_t side = state.range(0);
+  const auto graph = make_grid_graph(side);
+  mr::HashMap<std::uint64_t, std::uint32_t> weights;
+  for (std::size_t node = 0; node < side * side; ++node) {
+    const auto children = *graph.node_children(node);
+    for (std::size_t child : children) {
+      weights.try_emplace(node << 32 | child, grid_weight(node, child));
+    }
+  }
+  auto weight = [&](std::size_t from, std::size_t to) { return *weights.find(from << 32 | to); };
+  mr::PathScratch<std::size_t> scratch;
+  for (auto _ : state) {
+    auto path = graph.find_path_weighted(0, side * side - 1, weight, scratch);
+    benchmark::DoNotOptimize(path);
+  }
+  state.SetComplexityN(side * side);
+}
+
+BENCHMARK(BM_FindPathRandom)->RangeMultiplier(4)->Range(256, 1 << 20)->Complexity();
+BENCHMARK(BM_FindPathRandomBidirectional)->RangeMultiplier(4)->Range(256, 1 << 20)->Complexity();
+BENCHMARK(BM_FindPathGrid)->RangeMultiplier(2)->Range(16, 1024)->Complexity();
+BENCHMARK(BM_FindPathGridDijkstra)->RangeMultiplier(2)->Range(16, 1024)->Complexity();
+BENCHMARK(BM_FindPathGridWeightColumn)->RangeMultiplier(2)->Range(16, 1024)->Complexity();
+BENCHMARK(BM_FindPathGridWeightSideMap)->RangeMultiplier(2)->Range(16, 1024)->Complexity();
+
+// range(0): edges, 8 per node on average (repeats included)
+static std::vector<mr::Graph<int>::Edge> make_edge_list(std::size_t num_edges) {
+  std::mt19937_64 rng(13);
+  std::vector<mr::Graph<int>::Edge> edges(num_edges);
+  for (auto &[src, dest] : edges) {
+    src = rng() % (num_edges / 8);
+    dest = rng() % (num_edges / 8);
+  }
+  return edges;
+}
+
+static mr::Vector<int> make_graph_nodes(std::size_t num_nodes) {
+  mr::Vector<int> nodes;
+  nodes.reserve(num_nodes);
+  for (std::size_t i = 0; i < num_nodes; ++i) {
+    nodes.emplace_back(i);
+  }
+  return nodes;
+}
+
+static void BM_GraphAddEdge(benchmark::State &state) {
+  const auto edges = make_edge_list(state.range(0));
+  const auto nodes = make_graph_nodes(state.range(0) / 8);
+  for (auto _ : state) {
+    mr::Graph<int> graph;
+    for (int node : nodes) {
+      graph.add_node(node);
+    }
+    for (auto [src, dest] : edges) {
+      graph.add_edge(src, dest);
+    }
+    benchmark::DoNotOptimize(graph.nodes().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_GraphFromEdges(benchmark::State &state) {
+  const auto edges = make_edge_list(state.range(0));
+  const auto nodes = make_graph_nodes(state.range(0) / 8);
+  for (auto _ : state) {
+    auto graph = mr::Graph<int>::from_edges(nodes, edges);
+    benchmark::DoNotOptimize(graph.nodes().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_GraphFromEdgesParallel(benchmark::State &state) {
+  const auto edges = make_edge_list(state.range(0));
+  const auto nodes = make_graph_nodes(state.range(0) / 8);
+  for (auto _ : state) {
+    auto graph = mr::Graph<int>::from_edges(mr::par, nodes, edges);
+    benchmark::DoNotOptimize(graph.nodes().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_GraphAddEdge)->RangeMultiplier(4)->Range(1 << 10, 1 << 16)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GraphFromEdges)->RangeMultiplier(4)->Range(1 << 10, 16 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GraphFromEdgesParallel)->RangeMultiplier(4)->Range(1 << 10, 16 << 20)->Unit(benchmark::kMillisecond);
+
+// range(0): nodes; 1024 value lookups per iteration
+static void BM_GraphFindScan(benchmark::State &state) {
+  const auto graph = mr::Graph<int>::from_edges(make_graph_nodes(state.range(0)), {});
+  std::mt19937_64 rng(17);
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) {
+      benchmark::DoNotOptimize(graph.find(rng() % state.range(0)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+static void BM_GraphFindIndexed(benchmark::State &state) {
+  auto graph = mr::Graph<int>::from_edges(make_graph_nodes(state.range(0)), {});
+  graph.index_nodes();
+  std::mt19937_64 rng(17);
+  for (auto _ : state) {
+    for (int i = 0; i < 1024; ++i) {
+      benchmark::DoNotOptimize(graph.find(rng() % state.range(0)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+static void BM_GraphFindManyUnindexed(benchmark::State &state) {
+  const auto graph = mr::Graph<int>::from_edges(make_graph_nodes(state.range(0)), {});
+  std::mt19937_64 rng(17);
+  mr::Vector<int> values;
+  for (int i = 0; i < 1024; ++i) {
+    values.emplace_back(rng() % state.range(0));
+  }
+  for (auto _ : state) {
+    auto ids = graph.find_many({values.data(), values.size()});
+    benchmark::DoNotOptimize(ids.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+BENCHMARK(BM_GraphFindScan)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(BM_GraphFindIndexed)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK(BM_GraphFindManyUnindexed)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+
+// random graph with 8 edges per node and its transpose, kept while one size runs
+static const std::pair<mr::Graph<int>, mr::Graph<int>> & cached_random_graph(std::size_t num_nodes) {
+  static std::size_t cached_nodes = 0;
+  static std::pair<mr::Graph<int>, mr::Graph<int>> graphs;
+  if (cached_nodes != num_nodes) {
+    std::mt19937_64 rng(19);
+    std::vector<mr::Graph<int>::Edge> edges(num_nodes * 8);
+    for (auto &[src, dest] : edges) {
+      src = rng() % num_nodes;
+      dest = rng() % num_nodes;
+    }
+    graphs.first = mr::Graph<int>::from_edges(mr::par, make_graph_nodes(num_nodes), edges);
+    graphs.second = graphs.first.transposed();
+    cached_nodes = num_nodes;
+  }
+  return graphs;
+}
+
+// range(0): nodes, range(1): threads (the caller counts as one)
+static void BM_ParallelBfs(benchmark::State &state) {
+  const auto &[graph, reversed] = cached_random_graph(state.range(0));
+  mr::ThreadPool pool(state.range(1) - 1);
+  for (auto _ : state) {
+    auto depths = mr::bfs_depths(mr::par.on(pool), graph, reversed, 0);
+    benchmark::DoNotOptimize(depths.data());
+  }
+  state.SetItemsProcessed(state.iterations() * graph.destinations().size());
+}
+
+static void BM_ParallelConnectedComponents(benchmark::State &state) {
+  const auto &[graph, reversed] = cached_random_graph(state.range(0));
+  mr::ThreadPool pool(state.range(1) - 1);
+  for (auto _ : state) {
+    auto comp = mr::connected_components(mr::par.on(pool), graph, reversed);
+    benchmark::DoNotOptimize(comp.data());
+  }
+  state.SetItemsProcessed(state.iterations() * graph.destinations().size());
+}
+
+// 10 iterations per run
+static void BM_ParallelPageRank(benchmark::State &state) {
+  const auto &[graph, reversed] = cached_random_graph(state.range(0));
+  mr::ThreadPool pool(state.range(1) - 1);
+  for (auto _ : state) {
+    auto ranks = mr::pagerank(mr::par.on(pool), graph, reversed, 0.85, 10, 0);
+    benchmark::DoNotOptimize(ranks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * graph.destinations().size() * 10);
+}
+
+static void parallel_graph_args(benchmark::internal::Benchmark *bench) {
+  const std::int64_t cores = std::max(1u, std::thread::hardware_concurrency());
+  for (std::int64_t size = 1 << 16; size <= 1 << 22; size *= 8) {
+    for (std::int64_t threads = 1; threads < cores; threads *= 2) {
+      bench->Args({size, threads});
+    }
+    bench->Args({size, cores});
+  }
+}
+
+BENCHMARK(BM_ParallelBfs)->Apply(parallel_graph_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ParallelConnectedComponents)->Apply(parallel_graph_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ParallelPageRank)->Apply(parallel_graph_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// per-request vectors: filled, read and dropped on every iteration
+static void BM_VectorHeap(benchmark::State &state) {
+  const int len = state.range(0);
+  for (auto _ : state) {
+    mr::Vector<int> vec;
+    for (int i = 0; i < len; i++) {
+      vec.emplace_back(i);
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+}
+
+static void BM_VectorArena(benchmark::State &state) {
+  const int len = state.range(0);
+  mr::MonotonicArena arena;
+  for (auto _ : state) {
+    {
+      mr::Vector<int, mr::ArenaAllocator<int>> vec {mr::ArenaAllocator<int>(arena)};
+      for (int i = 0; i < len; i++) {
+        vec.emplace_back(i);
+      }
+      benchmark::DoNotOptimize(vec.data());
+    }
+    arena.reset();
+  }
+}
+
+static void BM_VectorPool(benchmark::State &state) {
+  const int len = state.range(0);
+  mr::FixedPool pool(8 * 1024 * sizeof(int), 16);
+  for (auto _ : state) {
+    mr::Vector<int, mr::PoolAllocator<int>> vec {mr::PoolAllocator<int>(pool)};
+    for (int i = 0; i < len; i++) {
+      vec.emplace_back(i);
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+}
+
+BENCHMARK(BM_VectorHeap)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_VectorArena)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(BM_VectorPool)->RangeMultiplier(4)->Range(16, 4096);
+
+// same layout as int, but forced through the element-wise move growth path
+struct NonRelocatableInt {
+  int value;
+};
+
+template <>
+  struct mr::is_trivially_relocatable<NonRelocatableInt> : std::false_type {};
+
+template <typename T>
+static void BM_VectorPushBack(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  for (auto _ : state) {
+    mr::Vector<T> vec;
+    for (std::size_t i = 0; i < len; i++) {
+      vec.emplace_back(static_cast<int>(i));
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+BENCHMARK_TEMPLATE(BM_VectorPushBack, int)
+    ->RangeMultiplier(10)
+    ->Range(1'000'000, 100'000'000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_VectorPushBack, NonRelocatableInt)
+    ->RangeMultiplier(10)
+    ->Range(1'000'000, 100'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+// sensor-batch style ingestion: many fixed-size batches appended to one buffer
+static void BM_VectorAppendLoop(benchmark::State &state) {
+  const std::size_t batch = state.range(0);
+  std::vector<int> src(batch, 42);
+  for (auto _ : state) {
+    mr::Vector<int> vec;
+    for (int b = 0; b < 64; b++) {
+      for (int x : src) {
+        vec.emplace_back(x);
+      }
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batch * 64);
+}
+
+static void BM_VectorAppendRange(benchmark::State &state) {
+  const std::size_t batch = state.range(0);
+  std::vector<int> src(batch, 42);
+  for (auto _ : state) {
+    mr::Vector<int> vec;
+    for (int b = 0; b < 64; b++) {
+      vec.append_range(src);
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batch * 64);
+}
+
+BENCHMARK(BM_VectorAppendLoop)->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(BM_VectorAppendRange)->RangeMultiplier(8)->Range(64, 32768);
+
+// drop every 4th element of an event list
+static mr::Vector<int> make_events(std::size_t len) {
+  mr::Vector<int> vec;
+  vec.reserve(len);
+  for (std::size_t i = 0; i < len; i++) {
+    vec.emplace_back(static_cast<int>(i));
+  }
+  return vec;
+}
+
+static void BM_VectorRemoveLoop(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  auto events = make_events(len);
+  for (auto _ : state) {
+    auto vec = events;
+    for (std::size_t i = 0; i < vec.size(); ) {
+      if (vec[i] % 4 == 0) {
+        vec.remove(i);
+      } else {
+        i++;
+      }
+    }
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetComplexityN(len);
+}
+
+static void BM_VectorEraseIf(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  auto events = make_events(len);
+  for (auto _ : state) {
+    auto vec = events;
+    vec.erase_if([](int x) { return x % 4 == 0; });
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetComplexityN(len);
+}
+
+static void BM_VectorRemoveIndices(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  auto events = make_events(len);
+  std::vector<std::size_t> ids;
+  for (std::size_t i = 0; i < len; i += 4) {
+    ids.push_back(i);
+  }
+  for (auto _ : state) {
+    auto vec = events;
+    vec.remove_indices(ids);
+    benchmark::DoNotOptimize(vec.data());
+  }
+  state.SetComplexityN(len);
+}
+
+BENCHMARK(BM_VectorRemoveLoop)->RangeMultiplier(4)->Range(256, 64 << 10)->Complexity();
+BENCHMARK(BM_VectorEraseIf)->RangeMultiplier(4)->Range(256, 64 << 10)->Complexity();
+BENCHMARK(BM_VectorRemoveIndices)->RangeMultiplier(4)->Range(256, 64 << 10)->Complexity();
+
+static void BM_SegmentedVectorPushBack(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  for (auto _ : state) {
+    mr::SegmentedVector<int> vec;
+    for (std::size_t i = 0; i < len; i++) {
+      vec.emplace_back(static_cast<int>(i));
+    }
+    benchmark::DoNotOptimize(&vec[0]);
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+BENCHMARK(BM_SegmentedVectorPushBack)
+    ->RangeMultiplier(10)
+    ->Range(1'000'000, 100'000'000)
+    ->Unit(benchmark::kMillisecond);
+
+// every thread appends batches of 100 to one shared vector
+template <typename T>
+struct MutexVector {
+  std::mutex m;
+  mr::Vector<T> vec;
+
+  void emplace_back(T value) {
+    std::lock_guard lg(m);
+    vec.emplace_back(value);
+  }
+};
+
+template <typename Vec>
+static void BM_SharedPushBack(benchmark::State &state) {
+  static Vec *vec = nullptr;
+  if (state.thread_index() == 0) {
+    vec = new Vec;
+  }
+  for (auto _ : state) {
+    for (int i = 0; i < 100; i++) {
+      vec->emplace_back(i);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 100);
+  if (state.thread_index() == 0) {
+    delete vec;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_SharedPushBack, MutexVector<int>)
+    ->ThreadRange(1, 64)
+    ->Iterations(2000)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SharedPushBack, mr::ConcurrentVector<int>)
+    ->ThreadRange(1, 64)
+    ->Iterations(2000)
+    ->UseRealTime();
+
+// std::unordered_map behind a reader-writer lock
+struct SharedMutexMap {
+  mutable std::shared_mutex m;
+  std::unordered_map<std::uint64_t, std::uint64_t> map;
+
+  void emplace(std::uint64_t key, std::uint64_t value) {
+    std::unique_lock lock(m);
+    map.insert_or_assign(key, value);
+  }
+
+  std::optional<std::uint64_t> find(std::uint64_t key) const {
+    std::shared_lock lock(m);
+    auto it = map.find(key);
+    return it == map.end() ? std::nullopt : std::optional(it->second);
+  }
+};
+
+// lookups and updates of 100'000 keys from every thread; range(0): percent of updates
+template <typename Map>
+static void BM_SharedMapMixed(benchmark::State &state) {
+  static Map *map = nullptr;
+  if (state.thread_index() == 0) {
+    map = new Map;
+    for (std::uint64_t key = 0; key < 100'000; key++) {
+      map->emplace(key, key);
+    }
+  }
+  std::mt19937_64 gen(state.thread_index());
+  const std::uint64_t write_percent = state.range(0);
+  for (auto _ : state) {
+    for (int i = 0; i < 100; i++) {
+      const std::uint64_t key = gen() % 100'000;
+      if (gen() % 100 < write_percent) {
+        map->emplace(key, key + 1);
+      } else {
+        benchmark::DoNotOptimize(map->find(key));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 100);
+  if (state.thread_index() == 0) {
+    delete map;
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_SharedMapMixed, SharedMutexMap)
+    ->ArgsProduct({{1, 50}})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SharedMapMixed, mr::ConcurrentHashMap<std::uint64_t, std::uint64_t>)
+    ->ArgsProduct({{1, 50}})
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+// needle placed at the end of the buffer: a full scan
+template <typename T>
+static void BM_ScalarFind(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  mr::Vector<T> vec;
+  vec.append_n(len, T(1));
+  vec[len - 1] = T(2);
+  for (auto _ : state) {
+    auto *it = begin(vec);
+    while (it != end(vec) && *it != T(2)) {
+      ++it;
+    }
+    benchmark::DoNotOptimize(it);
+  }
+  state.SetBytesProcessed(state.iterations() * len * sizeof(T));
+}
+
+template <typename T>
+static void BM_SimdFind(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  mr::Vector<T> vec;
+  vec.append_n(len, T(1));
+  vec[len - 1] = T(2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(mr::find(vec, T(2)));
+  }
+  state.SetBytesProcessed(state.iterations() * len * sizeof(T));
+}
+
+template <typename T>
+static void BM_SimdEqual(benchmark::State &state) {
+  const std::size_t len = state.range(0);
+  mr::Vector<T> lhs, rhs;
+  lhs.append_n(len, T(1));
+  rhs.append_n(len, T(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lhs == rhs);
+  }
+  state.SetBytesProcessed(state.iterations() * len * sizeof(T) * 2);
+}
+
+BENCHMARK_TEMPLATE(BM_ScalarFind, char)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_SimdFind, char)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_ScalarFind, int)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_SimdFind, int)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_SimdEqual, int)->Range(1 << 10, 1 << 22);
+
 // Run the benchmark
 BENCHMARK_MAIN();
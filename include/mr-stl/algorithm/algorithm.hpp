@@ -1,19 +1,27 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <functional>
 #include <iterator>
 #include <ranges>
+#include <utility>
+
+#include "mr-stl/algorithm/search.hpp"
+#include "mr-stl/algorithm/sorting_network.hpp"
+#include "mr-stl/span/span.hpp"
+#include "mr-stl/thread/thread_pool.hpp"
 
 namespace mr {
   // standard quick sort's partition function
-  template <typename It>
-    It partition(It begin, It end) {
+  template <typename It, typename Compare = std::less<>, typename Proj = std::identity>
+    It partition(It begin, It end, Compare cmp = {}, Proj proj = {}) {
       using std::swap;
       swap(begin[std::distance(begin, end) / 2], end[-1]);
       auto pivot = end - 1;
       auto i = begin;
       for (auto j = begin; j != pivot; ++j) {
-        if (*j < *pivot) {
+        if (std::invoke(cmp, std::invoke(proj, *j), std::invoke(proj, *pivot))) {
           std::swap(*i, *j);
           i++;
         }
@@ -26,42 +34,646 @@ namespace mr {
     void insertion_sort(It begin, It end) {
       auto distance = std::distance(begin, end);
 
-      for (std::size_t i = 1; i < distance; i++) {
-        auto tmp = begin[i];
-        std::size_t j = i - 1;
-        while (j >= 0 && tmp < begin[j]) {
-          begin[j + 1] = begin[j];
+      for (decltype(distance) i = 1; i < distance; i++) {
+        auto tmp = std::move(begin[i]);
+        auto j = i;
+        while (j > 0 && tmp < begin[j - 1]) {
+          begin[j] = std::move(begin[j - 1]);
           j--;
         }
-        begin[j + 1] = tmp;
+        begin[j] = std::move(tmp);
       }
     }
 
-  // quick sort falling back to insertion sort
-  template <typename It>
-    void sort(It begin, It end) {
-      // maximum number of elements fitting in a cacheline
-      static constexpr int max_batch_size =
-        std::hardware_destructive_interference_size /
-        sizeof(std::remove_cvref_t<decltype(*begin)>);
-
-      // divide until batch_size > max_batch_size
-      if (std::distance(begin, end) >= max_batch_size) {
-        // quick sort if not fitting in a cacheline
-        auto mid = partition(begin, end);
-        mr::sort(begin, mid);
-        mr::sort(mid+1, end);
-      } else if (std::distance(begin, end) > 1) {
-        // insertion_sort if fit in a cacheline
-        insertion_sort(begin, end);
+  namespace detail {
+    // below this size the leaf insertion sort wins over partitioning
+    // (branchless comparisons use sorting networks up to max_network_size instead)
+    inline constexpr std::ptrdiff_t insertion_sort_threshold = 24;
+    // above this size the pivot is a median of 3 medians (Tukey's ninther)
+    inline constexpr std::ptrdiff_t ninther_threshold = 128;
+    // partial_insertion_sort gives up after this many element moves
+    inline constexpr std::ptrdiff_t partial_insertion_limit = 8;
+    // elements scanned per block by the branchless partition (offsets fit in a byte)
+    inline constexpr std::ptrdiff_t partition_block_size = 64;
+
+    template <typename It, typename Compare>
+      void sort2(It a, It b, Compare &cmp) {
+        if (cmp(*b, *a)) {
+          std::iter_swap(a, b);
+        }
+      }
+
+    template <typename It, typename Compare>
+      void sort3(It a, It b, It c, Compare &cmp) {
+        sort2(a, b, cmp);
+        sort2(b, c, cmp);
+        sort2(a, b, cmp);
+      }
+
+    template <typename It, typename Compare>
+      void insertion_sort(It begin, It end, Compare &cmp) {
+        if (begin == end) {
+          return;
+        }
+        for (It cur = begin + 1; cur != end; ++cur) {
+          if (!cmp(*cur, cur[-1])) {
+            continue;
+          }
+          auto tmp = std::move(*cur);
+          It hole = cur;
+          do {
+            *hole = std::move(hole[-1]);
+            --hole;
+          } while (hole != begin && cmp(tmp, hole[-1]));
+          *hole = std::move(tmp);
+        }
+      }
+
+    // insertion sort without the lower bound check: begin[-1] must not be
+    // greater than any element of [begin, end)
+    template <typename It, typename Compare>
+      void unguarded_insertion_sort(It begin, It end, Compare &cmp) {
+        if (begin == end) {
+          return;
+        }
+        for (It cur = begin + 1; cur != end; ++cur) {
+          if (!cmp(*cur, cur[-1])) {
+            continue;
+          }
+          auto tmp = std::move(*cur);
+          It hole = cur;
+          do {
+            *hole = std::move(hole[-1]);
+            --hole;
+          } while (cmp(tmp, hole[-1]));
+          *hole = std::move(tmp);
+        }
+      }
+
+    // insertion sort that bails out after a few moves
+    // returns true if the range ended up sorted
+    template <typename It, typename Compare>
+      bool partial_insertion_sort(It begin, It end, Compare &cmp) {
+        if (begin == end) {
+          return true;
+        }
+        std::ptrdiff_t moves = 0;
+        for (It cur = begin + 1; cur != end; ++cur) {
+          if (!cmp(*cur, cur[-1])) {
+            continue;
+          }
+          auto tmp = std::move(*cur);
+          It hole = cur;
+          do {
+            *hole = std::move(hole[-1]);
+            --hole;
+          } while (hole != begin && cmp(tmp, hole[-1]));
+          *hole = std::move(tmp);
+
+          moves += cur - hole;
+          if (moves > partial_insertion_limit) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+    template <typename It, typename Compare>
+      void heap_sort(It begin, It end, Compare &cmp) {
+        std::make_heap(begin, end, cmp);
+        std::sort_heap(begin, end, cmp);
+      }
+
+    // places the median pivot candidate at *begin
+    template <typename It, typename Compare>
+      void choose_pivot(It begin, It end, Compare &cmp) {
+        const auto size = end - begin;
+        const auto half = size / 2;
+        if (size > ninther_threshold) {
+          sort3(begin, begin + half, end - 1, cmp);
+          sort3(begin + 1, begin + (half - 1), end - 2, cmp);
+          sort3(begin + 2, begin + (half + 1), end - 3, cmp);
+          sort3(begin + (half - 1), begin + half, begin + (half + 1), cmp);
+          std::iter_swap(begin, begin + half);
+        } else {
+          sort3(begin + half, begin, end - 1, cmp);
+        }
+      }
+
+    // partitions [begin, end) around the pivot *begin into [< pivot] pivot [>= pivot]
+    // returns the pivot position and whether the range was already partitioned
+    // requires an element >= pivot after begin (guaranteed by choose_pivot)
+    template <typename It, typename Compare>
+      std::pair<It, bool> partition_right(It begin, It end, Compare &cmp) {
+        auto pivot = std::move(*begin);
+        It first = begin;
+        It last = end;
+
+        while (cmp(*++first, pivot)) {}
+        // nothing before first may be < pivot, so the search has to be guarded
+        if (first - 1 == begin) {
+          while (first < last && !cmp(*--last, pivot)) {}
+        } else {
+          while (!cmp(*--last, pivot)) {}
+        }
+
+        const bool already_partitioned = first >= last;
+        while (first < last) {
+          std::iter_swap(first, last);
+          while (cmp(*++first, pivot)) {}
+          while (!cmp(*--last, pivot)) {}
+        }
+
+        It pivot_pos = first - 1;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return {pivot_pos, already_partitioned};
+      }
+
+    // swaps num misplaced pairs found by the block partition
+    template <typename It>
+      void swap_offsets(It first, It last, const unsigned char *offsets_l,
+                        const unsigned char *offsets_r, std::ptrdiff_t num, bool use_swaps) {
+        if (use_swaps) {
+          // keeps descending inputs linear: every pair is exchanged, not rotated
+          for (std::ptrdiff_t i = 0; i < num; i++) {
+            std::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+          }
+        } else if (num > 0) {
+          // cyclic rotation, one move per element instead of three
+          It l = first + offsets_l[0];
+          It r = last - offsets_r[0];
+          auto tmp = std::move(*l);
+          *l = std::move(*r);
+          for (std::ptrdiff_t i = 1; i < num; i++) {
+            l = first + offsets_l[i];
+            *r = std::move(*l);
+            r = last - offsets_r[i];
+            *l = std::move(*r);
+          }
+          *r = std::move(tmp);
+        }
+      }
+
+    // partition_right without data dependent branches (BlockQuicksort, Edelkamp & Weiss):
+    // comparison results are accumulated into offset buffers, then misplaced pairs are swapped
+    template <typename It, typename Compare>
+      std::pair<It, bool> partition_right_branchless(It begin, It end, Compare &cmp) {
+        auto pivot = std::move(*begin);
+        It first = begin;
+        It last = end;
+
+        while (cmp(*++first, pivot)) {}
+        if (first - 1 == begin) {
+          while (first < last && !cmp(*--last, pivot)) {}
+        } else {
+          while (!cmp(*--last, pivot)) {}
+        }
+
+        const bool already_partitioned = first >= last;
+        if (!already_partitioned) {
+          std::iter_swap(first, last);
+          ++first;
+
+          alignas(64) unsigned char offsets_l[partition_block_size];
+          alignas(64) unsigned char offsets_r[partition_block_size];
+          It base_l = first;
+          It base_r = last;
+          std::ptrdiff_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+          while (first < last) {
+            // refill whichever offset buffer ran empty
+            const std::ptrdiff_t unknown = last - first;
+            const std::ptrdiff_t left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+            const std::ptrdiff_t right_split = num_r == 0 ? unknown - left_split : 0;
+
+            const std::ptrdiff_t left_count = std::min(left_split, partition_block_size);
+            for (std::ptrdiff_t i = 0; i < left_count; i++) {
+              offsets_l[num_l] = static_cast<unsigned char>(i);
+              num_l += !cmp(*first, pivot);
+              ++first;
+            }
+            const std::ptrdiff_t right_count = std::min(right_split, partition_block_size);
+            for (std::ptrdiff_t i = 0; i < right_count;) {
+              offsets_r[num_r] = static_cast<unsigned char>(++i);
+              num_r += cmp(*--last, pivot);
+            }
+
+            const std::ptrdiff_t num = std::min(num_l, num_r);
+            swap_offsets(base_l, base_r, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+            if (num_l == 0) {
+              start_l = 0;
+              base_l = first;
+            }
+            if (num_r == 0) {
+              start_r = 0;
+              base_r = last;
+            }
+          }
+
+          // at most one buffer still holds misplaced elements, move them to the boundary
+          if (num_l != 0) {
+            while (num_l-- != 0) {
+              std::iter_swap(base_l + offsets_l[start_l + num_l], --last);
+            }
+            first = last;
+          }
+          if (num_r != 0) {
+            while (num_r-- != 0) {
+              std::iter_swap(base_r - offsets_r[start_r + num_r], first);
+              ++first;
+            }
+            last = first;
+          }
+        }
+
+        It pivot_pos = first - 1;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return {pivot_pos, already_partitioned};
       }
-    }
 
-  // ranges version (could be surrounded with ifdef)
-  void sort(std::ranges::range auto &range) {
-    auto b = begin(range);
-    auto e = end(range);
+    // partitions around the pivot *begin into [<= pivot] [> pivot]
+    // used when the pivot equals the element preceding the range: everything
+    // equal to it ends up on the left and never has to be sorted again
+    template <typename It, typename Compare>
+      It partition_left(It begin, It end, Compare &cmp) {
+        auto pivot = std::move(*begin);
+        It first = begin;
+        It last = end;
 
-    mr::sort(b, e);
+        while (cmp(pivot, *--last)) {}
+        if (last + 1 == end) {
+          while (first < last && !cmp(pivot, *++first)) {}
+        } else {
+          while (!cmp(pivot, *++first)) {}
+        }
+
+        while (first < last) {
+          std::iter_swap(first, last);
+          while (cmp(pivot, *--last)) {}
+          while (!cmp(pivot, *++first)) {}
+        }
+
+        It pivot_pos = last;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return pivot_pos;
+      }
+
+    // breaks patterns that made the last partition unbalanced
+    template <typename It>
+      void shuffle_partition(It begin, It end) {
+        const auto size = end - begin;
+        if (size < insertion_sort_threshold) {
+          return;
+        }
+        std::iter_swap(begin, begin + size / 4);
+        std::iter_swap(end - 1, end - size / 4);
+        if (size > ninther_threshold) {
+          std::iter_swap(begin + 1, begin + (size / 4 + 1));
+          std::iter_swap(begin + 2, begin + (size / 4 + 2));
+          std::iter_swap(end - 2, end - (size / 4 + 1));
+          std::iter_swap(end - 3, end - (size / 4 + 2));
+        }
+      }
+
+    // one step of pattern-defeating quicksort (Orson Peters' pdqsort):
+    // - median of 3 / ninther pivots
+    // - runs of equal elements are split off by partition_left
+    // - already partitioned ranges are finished by a bounded insertion sort,
+    //   which makes sorted and reversed inputs linear
+    // - unbalanced partitions shuffle elements, and after log2(n) of them
+    //   the range is heap sorted, bounding the worst case to O(n log n)
+    // returns end if [begin, end) is sorted, otherwise the pivot position; begin
+    // may move past elements that are already in place
+    template <bool Branchless, typename It, typename Compare>
+      It partition_step(It &begin, It end, Compare &cmp, int &bad_allowed, bool leftmost) {
+        while (true) {
+          const auto size = end - begin;
+          if constexpr (Branchless) {
+            if (size <= static_cast<decltype(size)>(max_network_size)) {
+              sort_small(begin, size, cmp);
+              return end;
+            }
+          }
+          if (size < insertion_sort_threshold) {
+            if (leftmost) {
+              insertion_sort(begin, end, cmp);
+            } else {
+              unguarded_insertion_sort(begin, end, cmp);
+            }
+            return end;
+          }
+
+          choose_pivot(begin, end, cmp);
+
+          // begin[-1] is the pivot of an enclosing partition: if it equals our
+          // pivot, nothing in this range is smaller than it
+          if (!leftmost && !cmp(begin[-1], *begin)) {
+            begin = partition_left(begin, end, cmp) + 1;
+            continue;
+          }
+
+          auto [pivot_pos, already_partitioned] = Branchless ?
+            partition_right_branchless(begin, end, cmp) :
+            partition_right(begin, end, cmp);
+
+          const auto left_size = pivot_pos - begin;
+          const auto right_size = end - (pivot_pos + 1);
+          if (left_size < size / 8 || right_size < size / 8) [[unlikely]] {
+            if (--bad_allowed == 0) {
+              heap_sort(begin, end, cmp);
+              return end;
+            }
+            shuffle_partition(begin, pivot_pos);
+            shuffle_partition(pivot_pos + 1, end);
+          } else if (already_partitioned &&
+                     partial_insertion_sort(begin, pivot_pos, cmp) &&
+                     partial_insertion_sort(pivot_pos + 1, end, cmp)) {
+            return end;
+          }
+          return pivot_pos;
+        }
+      }
+
+    template <bool Branchless, typename It, typename Compare>
+      void introsort_loop(It begin, It end, Compare &cmp, int bad_allowed, bool leftmost) {
+        while (true) {
+          const It pivot_pos = partition_step<Branchless>(begin, end, cmp, bad_allowed, leftmost);
+          if (pivot_pos == end) {
+            return;
+          }
+          // recurse into the left part, loop on the right one
+          introsort_loop<Branchless>(begin, pivot_pos, cmp, bad_allowed, leftmost);
+          begin = pivot_pos + 1;
+          leftmost = false;
+        }
+      }
+
+    template <typename It>
+      int sort_bad_allowed(It begin, It end) {
+        return std::bit_width(static_cast<std::make_unsigned_t<std::iter_difference_t<It>>>(end - begin));
+      }
+
+    template <typename K>
+      concept RadixKey = (std::is_integral_v<K> || std::is_floating_point_v<K>) &&
+        (sizeof(K) == 1 || sizeof(K) == 2 || sizeof(K) == 4 || sizeof(K) == 8);
+
+    template <typename It, typename Key>
+      using radix_key_t = std::remove_cvref_t<std::invoke_result_t<Key &, std::iter_reference_t<It>>>;
+
+    // below this size introsort beats clearing and scanning the histograms
+    inline constexpr std::ptrdiff_t radix_sort_threshold = 1 << 10;
+
+    // maps a key to an unsigned integer with the same order
+    // (signed: flip the sign bit, floating point: flip all bits of negatives)
+    template <RadixKey K>
+      constexpr auto radix_bits(K key) noexcept {
+        using U = lane_t<sizeof(K)>;
+        constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+        if constexpr (std::is_floating_point_v<K>) {
+          const U bits = std::bit_cast<U>(key);
+          return (bits & sign) != 0 ? U(~bits) : U(bits | sign);
+        } else if constexpr (std::is_signed_v<K>) {
+          return U(static_cast<U>(key) ^ sign);
+        } else {
+          return static_cast<U>(key);
+        }
+      }
+
+    // 8-bit digits for short keys, 11-bit (3 passes per 32 bits) otherwise,
+    // 16-bit for 64-bit keys once the input dwarfs the 4 x 64K histograms
+    template <typename K>
+      constexpr unsigned radix_digit_bits(std::size_t size) noexcept {
+        if constexpr (sizeof(K) <= 2) {
+          return 8;
+        } else if constexpr (sizeof(K) == 4) {
+          return 11;
+        } else {
+          return size >= (std::size_t(1) << 22) ? 16 : 11;
+        }
+      }
+
+    // stable LSD radix sort, one histogram pass plus one scatter pass per digit
+    // digits on which all keys agree are skipped
+    // returns false (leaving the range untouched) if the scratch buffer cannot be allocated
+    template <unsigned DigitBits, typename It, typename Key>
+      bool lsd_radix_sort(It begin, It end, Key &key) {
+        using T = std::iter_value_t<It>;
+        using U = decltype(radix_bits(std::invoke(key, *begin)));
+        // raw slots, constructed by the first scatter into them
+        using Scratch = OwningSpan<T, HeapAllocator<T>, uninitialized_storage_t>;
+        constexpr std::size_t buckets = std::size_t(1) << DigitBits;
+        constexpr unsigned digits = (sizeof(U) * 8 + DigitBits - 1) / DigitBits;
+        constexpr std::size_t mask = buckets - 1;
+        const std::size_t size = end - begin;
+
+        Scratch buffer(size);
+        OwningSpan<std::size_t, HeapAllocator<std::size_t>, uninitialized_storage_t> counts(digits * buckets);
+        if (buffer.data() == nullptr || counts.data() == nullptr) [[unlikely]] {
+          return false;
+        }
+        std::fill_n(counts.data(), counts.size(), 0);
+
+        // histograms of every digit in a single read pass
+        for (It it = begin; it != end; ++it) {
+          const U bits = radix_bits(std::invoke(key, *it));
+          for (unsigned d = 0; d < digits; d++) {
+            counts[d * buckets + ((bits >> (d * DigitBits)) & mask)]++;
+          }
+        }
+
+        T *scratch = buffer.data();
+        bool in_scratch = false;
+        bool scratch_live = false;
+        for (unsigned d = 0; d < digits; d++) {
+          std::size_t *offsets = counts.data() + d * buckets;
+          if (std::find(offsets, offsets + buckets, size) != offsets + buckets) {
+            continue;
+          }
+
+          std::size_t sum = 0;
+          for (std::size_t b = 0; b < buckets; b++) {
+            sum += std::exchange(offsets[b], sum);
+          }
+
+          const unsigned shift = d * DigitBits;
+          auto scatter = [&](auto from, auto to, auto construct) {
+            for (std::size_t i = 0; i < size; i++) {
+              auto &&elem = from[i];
+              auto dst = to + offsets[(radix_bits(std::invoke(key, elem)) >> shift) & mask]++;
+              if constexpr (decltype(construct)::value) {
+                std::construct_at(dst, std::move(elem));
+              } else {
+                *dst = std::move(elem);
+              }
+            }
+          };
+          if (in_scratch) {
+            scatter(scratch, begin, std::false_type {});
+          } else if (scratch_live) {
+            scatter(begin, scratch, std::false_type {});
+          } else {
+            scatter(begin, scratch, std::true_type {});
+            scratch_live = true;
+          }
+          in_scratch = !in_scratch;
+        }
+
+        if (in_scratch) {
+          std::move(scratch, scratch + size, begin);
+        }
+        if (scratch_live) {
+          std::destroy_n(scratch, size);
+        }
+        return true;
+      }
+
+    template <typename It, typename Key>
+      void radix_sort(It begin, It end, Key key) {
+        const auto size = end - begin;
+        if (size < 2) {
+          return;
+        }
+
+        using K = radix_key_t<It, Key>;
+        bool sorted = false;
+        if (radix_digit_bits<K>(size) == 16) {
+          sorted = lsd_radix_sort<16>(begin, end, key);
+        } else if (radix_digit_bits<K>(size) == 11) {
+          sorted = lsd_radix_sort<11>(begin, end, key);
+        } else {
+          sorted = lsd_radix_sort<8>(begin, end, key);
+        }
+
+        if (!sorted) [[unlikely]] {
+          // out of memory: sort in place by the same order (not stable)
+          auto cmp = [&key](const auto &lhs, const auto &rhs) {
+            return radix_bits(std::invoke(key, lhs)) < radix_bits(std::invoke(key, rhs));
+          };
+          introsort_loop<false>(begin, end, cmp, sort_bad_allowed(begin, end), true);
+        }
+      }
+
+    template <typename It, typename Compare>
+      void sort(It begin, It end, Compare cmp) {
+        const auto size = end - begin;
+        if (size < 2) {
+          return;
+        }
+        using T = std::iter_value_t<It>;
+        if constexpr (RadixKey<T> && is_less_v<T, Compare>) {
+          if (size >= radix_sort_threshold) {
+            radix_sort(begin, end, std::identity{});
+            return;
+          }
+        }
+        introsort_loop<branchless_compare_v<T, Compare>>(begin, end, cmp, sort_bad_allowed(begin, end), true);
+      }
+
+    // partitions smaller than this are sorted by a single task
+    inline constexpr std::ptrdiff_t parallel_sort_grain = 1 << 14;
+
+    // introsort_loop forking the left part of every split into tasks
+    // pivots are never moved again, so the begin[-1] sentinels stay valid across tasks
+    template <bool Branchless, typename It, typename Compare>
+      void parallel_introsort_loop(TaskGroup &tasks, It begin, It end, Compare cmp, int bad_allowed, bool leftmost) {
+        while (end - begin > parallel_sort_grain) {
+          const It pivot_pos = partition_step<Branchless>(begin, end, cmp, bad_allowed, leftmost);
+          if (pivot_pos == end) {
+            return;
+          }
+          tasks.run([&tasks, begin, pivot_pos, cmp, bad_allowed, leftmost] {
+            parallel_introsort_loop<Branchless>(tasks, begin, pivot_pos, cmp, bad_allowed, leftmost);
+          });
+          begin = pivot_pos + 1;
+          leftmost = false;
+        }
+        // leaves are sorted like independent inputs, so they may take the radix path
+        detail::sort(begin, end, cmp);
+      }
+
+    template <typename It, typename Compare>
+      void sort(const parallel_policy_t &policy, It begin, It end, Compare cmp) {
+        if (end - begin <= parallel_sort_grain) {
+          detail::sort(begin, end, cmp);
+          return;
+        }
+        using T = std::iter_value_t<It>;
+        TaskGroup tasks(policy.executor());
+        parallel_introsort_loop<branchless_compare_v<T, Compare>>(
+          tasks, begin, end, cmp, sort_bad_allowed(begin, end), true);
+        tasks.wait();
+      }
   }
+
+  namespace detail {
+    // cmp applied to projected elements; the identity projection keeps cmp itself,
+    // so std::less/std::greater are still recognized by the sort kernels
+    template <typename Compare, typename Proj>
+      auto projected_compare(Compare &cmp, Proj &proj) {
+        if constexpr (std::is_same_v<Proj, std::identity>) {
+          return cmp;
+        } else {
+          return [&cmp, &proj](const auto &lhs, const auto &rhs) -> bool {
+            return std::invoke(cmp, std::invoke(proj, lhs), std::invoke(proj, rhs));
+          };
+        }
+      }
+  }
+
+  // pattern-defeating introsort, O(n log n) worst case (see detail::partition_step)
+  // integral and floating point keys above detail::radix_sort_threshold are radix sorted
+  template <std::random_access_iterator It, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<It, Compare, Proj>
+    void sort(It begin, It end, Compare cmp = {}, Proj proj = {}) {
+      if constexpr (!std::is_same_v<Proj, std::identity>) {
+        using K = detail::radix_key_t<It, Proj>;
+        if constexpr (detail::RadixKey<K> && detail::is_less_v<K, Compare>) {
+          if (end - begin >= detail::radix_sort_threshold) {
+            detail::radix_sort(begin, end, proj);
+            return;
+          }
+        }
+      }
+      detail::sort(begin, end, detail::projected_compare(cmp, proj));
+    }
+
+  template <std::ranges::random_access_range R, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Compare, Proj>
+    void sort(R &range, Compare cmp = {}, Proj proj = {}) {
+      mr::sort(begin(range), end(range), std::move(cmp), std::move(proj));
+    }
+
+  // forks partitions larger than detail::parallel_sort_grain onto the policy's pool
+  template <std::random_access_iterator It, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<It, Compare, Proj>
+    void sort(const parallel_policy_t &policy, It begin, It end, Compare cmp = {}, Proj proj = {}) {
+      detail::sort(policy, begin, end, detail::projected_compare(cmp, proj));
+    }
+
+  template <std::ranges::random_access_range R, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Compare, Proj>
+    void sort(const parallel_policy_t &policy, R &range, Compare cmp = {}, Proj proj = {}) {
+      mr::sort(policy, begin(range), end(range), std::move(cmp), std::move(proj));
+    }
+
+  // stable LSD radix sort by an integral or floating point key, O(n * sizeof(key))
+  // elements only need to be movable: the scratch buffer is constructed by moving into it
+  template <std::random_access_iterator It, typename Key = std::identity>
+    requires detail::RadixKey<detail::radix_key_t<It, Key>>
+    void radix_sort(It begin, It end, Key key = {}) {
+      detail::radix_sort(begin, end, std::move(key));
+    }
+
+  template <std::ranges::random_access_range R, typename Key = std::identity>
+    requires detail::RadixKey<detail::radix_key_t<std::ranges::iterator_t<R>, Key>>
+    void radix_sort(R &range, Key key = {}) {
+      detail::radix_sort(begin(range), end(range), std::move(key));
+    }
 }
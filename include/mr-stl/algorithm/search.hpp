@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#if defined(__AVX2__) || defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
+#include "mr-stl/def.hpp"
+
+namespace mr {
+  // ranges over contiguous storage (all FlatRangeMethods ranges, std::vector, std::span, ...)
+  template <typename R>
+    concept FlatRange = requires (R &r) {
+      { r.data() } -> std::convertible_to<const void *>;
+      { r.size() } -> std::convertible_to<std::size_t>;
+    };
+
+  template <typename R>
+    using range_element_t = std::remove_cvref_t<decltype(*begin(std::declval<R &>()))>;
+
+  namespace detail {
+    // types whose equality is bitwise equality, so lanes can be compared in bulk
+    template <typename T>
+      concept SimdComparable =
+        (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) &&
+        (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+    template <std::size_t S>
+      using lane_t = std::conditional_t<S == 1, std::uint8_t,
+                     std::conditional_t<S == 2, std::uint16_t,
+                     std::conditional_t<S == 4, std::uint32_t, std::uint64_t>>>;
+
+    // kernels are selected at compile time by the target flags (e.g. -march=native)
+#if defined(__AVX2__)
+#  define MR_STL_SIMD 1
+    using simd_reg = __m256i;
+    inline constexpr std::size_t simd_width = 32;
+
+    inline simd_reg simd_load(const void *ptr) noexcept {
+      return _mm256_loadu_si256(static_cast<const simd_reg *>(ptr));
+    }
+
+    template <typename T>
+      simd_reg simd_broadcast(T value) noexcept {
+        auto lane = std::bit_cast<lane_t<sizeof(T)>>(value);
+        if constexpr (sizeof(T) == 1) { return _mm256_set1_epi8(static_cast<char>(lane)); }
+        else if constexpr (sizeof(T) == 2) { return _mm256_set1_epi16(static_cast<short>(lane)); }
+        else if constexpr (sizeof(T) == 4) { return _mm256_set1_epi32(static_cast<int>(lane)); }
+        else { return _mm256_set1_epi64x(static_cast<long long>(lane)); }
+      }
+
+    template <std::size_t S>
+      simd_reg simd_cmpeq(simd_reg a, simd_reg b) noexcept {
+        if constexpr (S == 1) { return _mm256_cmpeq_epi8(a, b); }
+        else if constexpr (S == 2) { return _mm256_cmpeq_epi16(a, b); }
+        else if constexpr (S == 4) { return _mm256_cmpeq_epi32(a, b); }
+        else { return _mm256_cmpeq_epi64(a, b); }
+      }
+
+    // one bit per byte
+    inline std::uint32_t simd_mask(simd_reg reg) noexcept {
+      return static_cast<std::uint32_t>(_mm256_movemask_epi8(reg));
+    }
+#elif defined(__SSE2__)
+#  define MR_STL_SIMD 1
+    using simd_reg = __m128i;
+    inline constexpr std::size_t simd_width = 16;
+
+    inline simd_reg simd_load(const void *ptr) noexcept {
+      return _mm_loadu_si128(static_cast<const simd_reg *>(ptr));
+    }
+
+    template <typename T>
+      simd_reg simd_broadcast(T value) noexcept {
+        auto lane = std::bit_cast<lane_t<sizeof(T)>>(value);
+        if constexpr (sizeof(T) == 1) { return _mm_set1_epi8(static_cast<char>(lane)); }
+        else if constexpr (sizeof(T) == 2) { return _mm_set1_epi16(static_cast<short>(lane)); }
+        else if constexpr (sizeof(T) == 4) { return _mm_set1_epi32(static_cast<int>(lane)); }
+        else { return _mm_set1_epi64x(static_cast<long long>(lane)); }
+      }
+
+    template <std::size_t S>
+      simd_reg simd_cmpeq(simd_reg a, simd_reg b) noexcept {
+        if constexpr (S == 1) { return _mm_cmpeq_epi8(a, b); }
+        else if constexpr (S == 2) { return _mm_cmpeq_epi16(a, b); }
+        else if constexpr (S == 4) { return _mm_cmpeq_epi32(a, b); }
+        else {
+#  if defined(__SSE4_1__)
+          return _mm_cmpeq_epi64(a, b);
+#  else
+          // both 32-bit halves have to match
+          simd_reg eq = _mm_cmpeq_epi32(a, b);
+          return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+#  endif
+        }
+      }
+
+    inline std::uint32_t simd_mask(simd_reg reg) noexcept {
+      return static_cast<std::uint32_t>(_mm_movemask_epi8(reg));
+    }
+#else
+#  define MR_STL_SIMD 0
+#endif
+
+#if MR_STL_SIMD
+    inline constexpr std::uint32_t simd_full_mask = ~std::uint32_t(0) >> (32 - simd_width);
+#endif
+
+    // index of the first element equal to value, size if there is none
+    template <SimdComparable T>
+      std::size_t find_index(const T *data, std::size_t size, T value) noexcept {
+        std::size_t i = 0;
+#if MR_STL_SIMD
+        constexpr std::size_t lanes = simd_width / sizeof(T);
+        const simd_reg needle = simd_broadcast(value);
+        for (; i + lanes <= size; i += lanes) {
+          const std::uint32_t mask = simd_mask(simd_cmpeq<sizeof(T)>(simd_load(data + i), needle));
+          if (mask != 0) {
+            return i + std::countr_zero(mask) / sizeof(T);
+          }
+        }
+#endif
+        for (; i < size; i++) {
+          if (data[i] == value) {
+            return i;
+          }
+        }
+        return size;
+      }
+
+    template <SimdComparable T>
+      std::size_t count(const T *data, std::size_t size, T value) noexcept {
+        std::size_t result = 0;
+        std::size_t i = 0;
+#if MR_STL_SIMD
+        constexpr std::size_t lanes = simd_width / sizeof(T);
+        const simd_reg needle = simd_broadcast(value);
+        for (; i + lanes <= size; i += lanes) {
+          const std::uint32_t mask = simd_mask(simd_cmpeq<sizeof(T)>(simd_load(data + i), needle));
+          result += std::popcount(mask) / sizeof(T);
+        }
+#endif
+        for (; i < size; i++) {
+          result += data[i] == value;
+        }
+        return result;
+      }
+
+    // index of the first position where a and b differ, size if there is none
+    template <SimdComparable T>
+      std::size_t mismatch(const T *a, const T *b, std::size_t size) noexcept {
+        std::size_t i = 0;
+#if MR_STL_SIMD
+        constexpr std::size_t lanes = simd_width / sizeof(T);
+        for (; i + lanes <= size; i += lanes) {
+          const std::uint32_t mask = simd_mask(simd_cmpeq<sizeof(T)>(simd_load(a + i), simd_load(b + i)));
+          if (mask != simd_full_mask) {
+            return i + std::countr_one(mask) / sizeof(T);
+          }
+        }
+#endif
+        for (; i < size; i++) {
+          if (a[i] != b[i]) {
+            return i;
+          }
+        }
+        return size;
+      }
+
+    template <typename R, typename T>
+      concept SimdSearchable = FlatRange<R> &&
+        SimdComparable<range_element_t<R>> &&
+        std::is_same_v<range_element_t<R>, std::remove_cvref_t<T>>;
+
+    template <typename R1, typename R2>
+      concept SimdComparableRanges = FlatRange<R1> && FlatRange<R2> &&
+        SimdComparable<range_element_t<R1>> &&
+        std::is_same_v<range_element_t<R1>, range_element_t<R2>>;
+  }
+
+  // first element equal to value (end if there is none)
+  template <Range R, typename T>
+    auto find(R &&range, const T &value) {
+      if constexpr (detail::SimdSearchable<R, T>) {
+        return begin(range) + detail::find_index(range.data(), range.size(), value);
+      } else {
+        return std::find(begin(range), end(range), value);
+      }
+    }
+
+  template <Range R, typename T>
+    std::size_t count(R &&range, const T &value) {
+      if constexpr (detail::SimdSearchable<R, T>) {
+        return detail::count(range.data(), range.size(), value);
+      } else {
+        return std::count(begin(range), end(range), value);
+      }
+    }
+
+  template <Range R, typename T>
+    requires (!std::is_invocable_v<const T &, range_element_t<R>>)
+    bool contains(R &&range, const T &value) {
+      return mr::find(range, value) != end(range);
+    }
+
+  // index of the first position where the ranges differ (length of the shorter if none)
+  template <Range R1, Range R2>
+    std::size_t mismatch(const R1 &lhs, const R2 &rhs) {
+      if constexpr (detail::SimdComparableRanges<R1, R2>) {
+        return detail::mismatch(lhs.data(), rhs.data(), std::min<std::size_t>(lhs.size(), rhs.size()));
+      } else {
+        auto [l, r] = std::mismatch(begin(lhs), end(lhs), begin(rhs), end(rhs));
+        return std::distance(begin(lhs), l);
+      }
+    }
+
+  template <Range R1, Range R2>
+    bool equal(const R1 &lhs, const R2 &rhs) {
+      if constexpr (detail::SimdComparableRanges<R1, R2>) {
+        return lhs.size() == rhs.size() &&
+          detail::mismatch(lhs.data(), rhs.data(), lhs.size()) == lhs.size();
+      } else {
+        return std::equal(begin(lhs), end(lhs), begin(rhs), end(rhs));
+      }
+    }
+
+  template <Range R1, Range R2>
+    bool lexicographical_compare(const R1 &lhs, const R2 &rhs) {
+      if constexpr (detail::SimdComparableRanges<R1, R2>) {
+        const std::size_t size = std::min<std::size_t>(lhs.size(), rhs.size());
+        const std::size_t i = detail::mismatch(lhs.data(), rhs.data(), size);
+        if (i == size) {
+          return lhs.size() < rhs.size();
+        }
+        return lhs.data()[i] < rhs.data()[i];
+      } else {
+        return std::lexicographical_compare(begin(lhs), end(lhs), begin(rhs), end(rhs));
+      }
+    }
+}
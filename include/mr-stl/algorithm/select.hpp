@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include "mr-stl/algorithm/algorithm.hpp"
+#include "mr-stl/vector/vector.hpp"
+
+namespace mr {
+  namespace detail {
+    // introselect: quickselect on introsort's pivots and partitions, O(n) expected;
+    // after log2(n) unbalanced partitions it heap selects, bounding the worst case to O(n log n)
+    template <typename It, typename Compare>
+      void nth_element(It begin, It nth, It end, Compare cmp) {
+        if (nth == end) {
+          return;
+        }
+
+        using T = std::iter_value_t<It>;
+        constexpr bool branchless = branchless_compare_v<T, Compare>;
+        int bad_allowed = sort_bad_allowed(begin, end);
+
+        while (end - begin >= insertion_sort_threshold) {
+          const auto size = end - begin;
+          choose_pivot(begin, end, cmp);
+          const It pivot_pos = branchless ?
+            partition_right_branchless(begin, end, cmp).first :
+            partition_right(begin, end, cmp).first;
+          if (pivot_pos == nth) {
+            return;
+          }
+
+          const auto left_size = pivot_pos - begin;
+          const auto right_size = end - (pivot_pos + 1);
+          if (left_size < size / 8 || right_size < size / 8) [[unlikely]] {
+            if (nth > pivot_pos && left_size < size / 8) {
+              // usually many keys equal to the pivot: split them off, they are all in place
+              const It equal_end = std::partition(pivot_pos + 1, end,
+                [&](const auto &elem) { return !cmp(*pivot_pos, elem); });
+              if (nth < equal_end) {
+                return;
+              }
+              // no equal keys means a plain bad partition, which must count towards the fallback
+              if (equal_end > pivot_pos + 1) {
+                begin = equal_end;
+                continue;
+              }
+            }
+            if (--bad_allowed == 0) {
+              std::partial_sort(begin, nth + 1, end, cmp);
+              return;
+            }
+            shuffle_partition(begin, pivot_pos);
+            shuffle_partition(pivot_pos + 1, end);
+          }
+
+          if (nth < pivot_pos) {
+            end = pivot_pos;
+          } else {
+            begin = pivot_pos + 1;
+          }
+        }
+        insertion_sort(begin, end, cmp);
+      }
+  }
+
+  // places the element that would be at nth in sorted order there, with no greater
+  // element before it and no smaller one after it; O(n) expected
+  template <std::random_access_iterator It, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<It, Compare, Proj>
+    void nth_element(It begin, It nth, It end, Compare cmp = {}, Proj proj = {}) {
+      detail::nth_element(begin, nth, end, detail::projected_compare(cmp, proj));
+    }
+
+  template <std::ranges::random_access_range R, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Compare, Proj>
+    void nth_element(R &range, std::ranges::iterator_t<R> nth, Compare cmp = {}, Proj proj = {}) {
+      mr::nth_element(begin(range), nth, end(range), std::move(cmp), std::move(proj));
+    }
+
+  // sorts the smallest middle - begin elements into [begin, middle); O(n + k log k)
+  template <std::random_access_iterator It, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<It, Compare, Proj>
+    void partial_sort(It begin, It middle, It end, Compare cmp = {}, Proj proj = {}) {
+      auto projected = detail::projected_compare(cmp, proj);
+      detail::nth_element(begin, middle, end, projected);
+      detail::sort(begin, middle, projected);
+    }
+
+  template <std::ranges::random_access_range R, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Compare, Proj>
+    void partial_sort(R &range, std::ranges::iterator_t<R> middle, Compare cmp = {}, Proj proj = {}) {
+      mr::partial_sort(begin(range), middle, end(range), std::move(cmp), std::move(proj));
+    }
+
+  // k greatest elements of a single pass over any input range, greatest first
+  // keeps a k element heap, so O(n log k) time and O(k) memory
+  template <std::ranges::input_range R, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::indirect_strict_weak_order<Compare, std::projected<std::ranges::iterator_t<R>, Proj>>
+    Vector<std::ranges::range_value_t<R>> top_k(R &&range, std::size_t k, Compare cmp = {}, Proj proj = {}) {
+      Vector<std::ranges::range_value_t<R>> heap;
+      if (k == 0) {
+        return heap;
+      }
+      heap.reserve(k);
+
+      // heap ordered by greater, so the weakest kept element is on top
+      auto greater = [&](const auto &lhs, const auto &rhs) -> bool {
+        return std::invoke(cmp, std::invoke(proj, rhs), std::invoke(proj, lhs));
+      };
+      for (auto &&elem : range) {
+        if (heap.size() < k) {
+          heap.emplace_back(elem);
+          std::push_heap(heap.data(), heap.data() + heap.size(), greater);
+        } else if (greater(elem, heap[0])) {
+          std::pop_heap(heap.data(), heap.data() + k, greater);
+          heap[k - 1] = elem;
+          std::push_heap(heap.data(), heap.data() + k, greater);
+        }
+      }
+      std::sort_heap(heap.data(), heap.data() + heap.size(), greater);
+      return heap;
+    }
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#endif
+
+#include "mr-stl/def.hpp"
+
+namespace mr {
+  namespace detail {
+    // largest size with a precomputed network
+    inline constexpr std::size_t max_network_size = 32;
+
+    // comparisons compile to flag-setting instructions, so compare-exchanges and
+    // partitions can turn them into conditional moves instead of branches
+    template <typename T, typename Compare>
+      inline constexpr bool branchless_compare_v =
+        std::is_arithmetic_v<T> &&
+        (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>> ||
+         std::is_same_v<Compare, std::greater<>> || std::is_same_v<Compare, std::greater<T>>);
+
+    template <typename T, typename Compare>
+      inline constexpr bool is_less_v = std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>;
+
+    struct NetworkPair {
+      std::uint8_t lo;
+      std::uint8_t hi;
+    };
+
+    // Batcher's odd-even merge sort network over the next power of two;
+    // comparators touching indices >= n are dropped (those slots act as +inf)
+    template <typename Fn>
+      constexpr void for_each_network_pair(std::size_t n, Fn &&fn) {
+        const std::size_t padded = std::bit_ceil(n);
+        for (std::size_t p = 1; p < padded; p <<= 1) {
+          for (std::size_t k = p; k >= 1; k >>= 1) {
+            for (std::size_t j = k % p; j + k < padded; j += 2 * k) {
+              for (std::size_t i = 0; i < k && i + j + k < padded; i++) {
+                const std::size_t lo = i + j;
+                const std::size_t hi = i + j + k;
+                if (lo / (2 * p) == hi / (2 * p) && hi < n) {
+                  fn(lo, hi);
+                }
+              }
+            }
+          }
+        }
+      }
+
+    template <std::size_t N>
+      constexpr auto make_sorting_network() {
+        constexpr std::size_t size = [] {
+          std::size_t count = 0;
+          for_each_network_pair(N, [&count](std::size_t, std::size_t) { count++; });
+          return count;
+        }();
+
+        std::array<NetworkPair, size> network {};
+        std::size_t i = 0;
+        for_each_network_pair(N, [&](std::size_t lo, std::size_t hi) {
+          network[i++] = {static_cast<std::uint8_t>(lo), static_cast<std::uint8_t>(hi)};
+        });
+        return network;
+      }
+
+    template <std::size_t N>
+      inline constexpr auto sorting_network = make_sorting_network<N>();
+
+    template <typename It, typename Compare>
+      void compare_exchange(It a, It b, Compare &cmp) {
+        if constexpr (branchless_compare_v<std::iter_value_t<It>, Compare>) {
+          const auto x = *a;
+          const auto y = *b;
+          const bool swap = cmp(y, x);
+          *a = swap ? y : x;
+          *b = swap ? x : y;
+        } else if (cmp(*b, *a)) {
+          std::iter_swap(a, b);
+        }
+      }
+
+    template <std::size_t N, typename It, typename Compare, std::size_t ...I>
+      void apply_network([[maybe_unused]] It begin, [[maybe_unused]] Compare &cmp, std::index_sequence<I...>) {
+        constexpr auto &network = sorting_network<N>;
+        (compare_exchange(begin + network[I].lo, begin + network[I].hi, cmp), ...);
+      }
+
+#if defined(__AVX2__)
+    // in-register bitonic sorts, one or two AVX2 registers of 32 or 64-bit keys
+    template <typename T>
+      concept SimdSortKey =
+        std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t> || std::is_same_v<T, float> ||
+        std::is_same_v<T, std::int64_t> || std::is_same_v<T, double>;
+
+    template <SimdSortKey T>
+      struct SimdSort {
+        static inline constexpr std::size_t lanes = 32 / sizeof(T);
+
+        static __m256i min(__m256i a, __m256i b) noexcept {
+          if constexpr (std::is_same_v<T, std::int32_t>) { return _mm256_min_epi32(a, b); }
+          else if constexpr (std::is_same_v<T, std::uint32_t>) { return _mm256_min_epu32(a, b); }
+          else if constexpr (std::is_same_v<T, float>) {
+            return _mm256_castps_si256(_mm256_min_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+          } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_castpd_si256(_mm256_min_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b)));
+          } else {
+            return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+          }
+        }
+
+        static __m256i max(__m256i a, __m256i b) noexcept {
+          if constexpr (std::is_same_v<T, std::int32_t>) { return _mm256_max_epi32(a, b); }
+          else if constexpr (std::is_same_v<T, std::uint32_t>) { return _mm256_max_epu32(a, b); }
+          else if constexpr (std::is_same_v<T, float>) {
+            return _mm256_castps_si256(_mm256_max_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+          } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_castpd_si256(_mm256_max_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b)));
+          } else {
+            return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+          }
+        }
+
+        // lane i exchanged with lane i ^ J
+        template <std::size_t J>
+          static __m256i partner(__m256i v) noexcept {
+            constexpr std::size_t dwords = J * sizeof(T) / 4;
+            if constexpr (dwords == 1) { return _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)); }
+            else if constexpr (dwords == 2) { return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)); }
+            else { return _mm256_permute2x128_si256(v, v, 0x01); }
+          }
+
+        static __m256i reverse(__m256i v) noexcept {
+          if constexpr (sizeof(T) == 4) {
+            return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+          } else {
+            return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3));
+          }
+        }
+
+        // one bitonic compare-exchange layer: lane i takes the max when it is the upper
+        // element of its pair in an ascending block (or the lower one in a descending block)
+        template <std::size_t K, std::size_t J>
+          static __m256i step(__m256i v) noexcept {
+            constexpr int mask = [] {
+              int dword_mask = 0;
+              for (std::size_t i = 0; i < lanes; i++) {
+                if (((i & J) != 0) != ((i & K) != 0)) {
+                  dword_mask |= (sizeof(T) == 4 ? 0b1 : 0b11) << (i * sizeof(T) / 4);
+                }
+              }
+              return dword_mask;
+            }();
+            const __m256i other = partner<J>(v);
+            return _mm256_blend_epi32(min(v, other), max(v, other), mask);
+          }
+
+        // sorts a register holding a bitonic sequence
+        template <std::size_t J = lanes / 2>
+          static __m256i merge(__m256i v) noexcept {
+            v = step<lanes, J>(v);
+            if constexpr (J > 1) {
+              return merge<J / 2>(v);
+            } else {
+              return v;
+            }
+          }
+
+        template <std::size_t K = 2>
+          static __m256i sort(__m256i v) noexcept {
+            if constexpr (K > lanes) {
+              return v;
+            } else {
+              v = [&]<std::size_t ...S>(std::index_sequence<S...>) {
+                ((v = step<K, ((K / 2) >> S)>(v)), ...);
+                return v;
+              }(std::make_index_sequence<std::countr_zero(K)>());
+              return sort<K * 2>(v);
+            }
+          }
+
+        static void sort1(T *data) noexcept {
+          auto *ptr = reinterpret_cast<__m256i *>(data);
+          _mm256_storeu_si256(ptr, sort(_mm256_loadu_si256(ptr)));
+        }
+
+        static void sort2(T *data) noexcept {
+          auto *ptr = reinterpret_cast<__m256i *>(data);
+          const __m256i a = sort(_mm256_loadu_si256(ptr));
+          const __m256i b = reverse(sort(_mm256_loadu_si256(ptr + 1)));
+          // a ++ reverse(b) is bitonic: split it into halves and merge each
+          _mm256_storeu_si256(ptr, merge(min(a, b)));
+          _mm256_storeu_si256(ptr + 1, merge(max(a, b)));
+        }
+      };
+#endif
+
+    template <std::size_t N, typename It, typename Compare>
+      void sort_small(It begin, Compare &cmp) {
+        static_assert(N <= max_network_size, "no sorting network precomputed for this size");
+#if defined(__AVX2__)
+        using T = std::iter_value_t<It>;
+        if constexpr (std::contiguous_iterator<It> && SimdSortKey<T> && is_less_v<T, Compare>) {
+          if constexpr (N == SimdSort<T>::lanes) {
+            SimdSort<T>::sort1(std::to_address(begin));
+            return;
+          } else if constexpr (N == 2 * SimdSort<T>::lanes) {
+            SimdSort<T>::sort2(std::to_address(begin));
+            return;
+          }
+        }
+#endif
+        apply_network<N>(begin, cmp, std::make_index_sequence<sorting_network<N>.size()>());
+      }
+
+    // sorts size <= max_network_size elements with the matching network
+    template <typename It, typename Compare>
+      void sort_small(It begin, std::size_t size, Compare &cmp) {
+        using Kernel = void (*)(It, Compare &);
+        static constexpr auto kernels = []<std::size_t ...N>(std::index_sequence<N...>) {
+          return std::array<Kernel, sizeof...(N)> {&sort_small<N, It, Compare>...};
+        }(std::make_index_sequence<max_network_size + 1>());
+        kernels[size](begin, cmp);
+      }
+  }
+
+  // sorts exactly N <= 32 elements starting at begin with a branchless comparison network
+  // (an in-register bitonic network for 8/16 x 32-bit or 4/8 x 64-bit keys with AVX2)
+  template <std::size_t N, std::random_access_iterator It>
+    void sort_small(It begin) {
+      std::less<> cmp;
+      detail::sort_small<N>(begin, cmp);
+    }
+
+  template <typename T, std::size_t N>
+    void sort_small(std::array<T, N> &array) {
+      mr::sort_small<N>(array.begin());
+    }
+}
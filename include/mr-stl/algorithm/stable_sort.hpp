@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iterator>
+
+#include "mr-stl/algorithm/algorithm.hpp"
+#include "mr-stl/vector/vector.hpp"
+
+namespace mr {
+  namespace detail {
+    // inputs shorter than this are a single binary insertion sorted run
+    inline constexpr std::ptrdiff_t min_merge = 64;
+
+    // run length in [min_merge / 2, min_merge] that splits n into close to a power of two runs
+    constexpr std::ptrdiff_t min_run_length(std::ptrdiff_t n) noexcept {
+      std::ptrdiff_t low_bits = 0;
+      while (n >= min_merge) {
+        low_bits |= n & 1;
+        n >>= 1;
+      }
+      return n + low_bits;
+    }
+
+    // length of the run starting at begin; strictly descending runs are
+    // reversed in place (strictly, so equal elements keep their order)
+    template <typename It, typename Compare>
+      std::ptrdiff_t count_run(It begin, It end, Compare &cmp) {
+        It cur = begin + 1;
+        if (cur == end) {
+          return 1;
+        }
+        if (cmp(*cur, *begin)) {
+          while (++cur != end && cmp(*cur, cur[-1])) {}
+          std::reverse(begin, cur);
+        } else {
+          while (++cur != end && !cmp(*cur, cur[-1])) {}
+        }
+        return cur - begin;
+      }
+
+    // extends the sorted prefix [begin, sorted) to [begin, end)
+    template <typename It, typename Compare>
+      void binary_insertion_sort(It begin, It sorted, It end, Compare &cmp) {
+        for (; sorted != end; ++sorted) {
+          It pos = std::upper_bound(begin, sorted, *sorted, cmp);
+          if (pos != sorted) {
+            auto tmp = std::move(*sorted);
+            std::move_backward(pos, sorted, sorted + 1);
+            *pos = std::move(tmp);
+          }
+        }
+      }
+
+    // merges the adjacent sorted runs [begin, mid) and [mid, end),
+    // moving only the shorter one out to scratch
+    template <typename It, typename Compare, typename T>
+      void merge_runs(It begin, It mid, It end, Compare &cmp, Vector<T> &scratch) {
+        // skip the prefix and suffix that are already in place, which is
+        // most of the work for nearly sorted inputs
+        begin = std::upper_bound(begin, mid, *mid, cmp);
+        if (begin == mid) {
+          return;
+        }
+        end = std::lower_bound(mid, end, mid[-1], cmp);
+
+        const bool left_shorter = mid - begin <= end - mid;
+        scratch.clear();
+        scratch.reserve(left_shorter ? mid - begin : end - mid);
+        if (scratch.capacity() < static_cast<std::size_t>(std::min(mid - begin, end - mid))) [[unlikely]] {
+          std::inplace_merge(begin, mid, end, cmp);
+          return;
+        }
+
+        if (left_shorter) {
+          scratch.move_range(begin, mid);
+          T *buf = scratch.data();
+          T *buf_end = buf + scratch.size();
+          It out = begin;
+          It right = mid;
+          while (buf != buf_end && right != end) {
+            if (cmp(*right, *buf)) {
+              *out++ = std::move(*right++);
+            } else {
+              *out++ = std::move(*buf++);
+            }
+          }
+          std::move(buf, buf_end, out);
+        } else {
+          scratch.move_range(mid, end);
+          T *buf = scratch.data();
+          T *buf_end = buf + scratch.size();
+          It out = end;
+          It left = mid;
+          while (buf != buf_end && left != begin) {
+            if (cmp(buf_end[-1], left[-1])) {
+              *--out = std::move(*--left);
+            } else {
+              *--out = std::move(*--buf_end);
+            }
+          }
+          std::move_backward(buf, buf_end, out);
+        }
+        scratch.clear();
+      }
+
+    // natural merge sort with TimSort's run detection and merge policy
+    // (including the invariant fix from Auger, Jugé, Nicaud and Pivoteau)
+    template <typename It, typename Compare, typename T>
+      void stable_sort(It begin, It end, Compare cmp, Vector<T> &scratch) {
+        const std::ptrdiff_t size = end - begin;
+        if (size < 2) {
+          return;
+        }
+
+        // {offset, length}; lengths grow at least like Fibonacci numbers down
+        // the stack, so 128 entries cover any addressable size
+        std::array<std::pair<std::ptrdiff_t, std::ptrdiff_t>, 128> runs;
+        std::size_t count = 0;
+
+        auto merge_at = [&](std::size_t i) {
+          const auto [offset, length] = runs[i];
+          const auto next_length = runs[i + 1].second;
+          merge_runs(begin + offset, begin + offset + length, begin + offset + length + next_length, cmp, scratch);
+          runs[i].second += next_length;
+          std::copy(runs.begin() + i + 2, runs.begin() + count, runs.begin() + i + 1);
+          count--;
+        };
+
+        const std::ptrdiff_t min_run = min_run_length(size);
+        for (std::ptrdiff_t offset = 0; offset < size;) {
+          It run = begin + offset;
+          std::ptrdiff_t length = count_run(run, end, cmp);
+          if (length < min_run) {
+            const std::ptrdiff_t forced = std::min(min_run, size - offset);
+            binary_insertion_sort(run, run + length, run + forced, cmp);
+            length = forced;
+          }
+          runs[count++] = {offset, length};
+          offset += length;
+
+          // keep run lengths decreasing like Fibonacci numbers, so merges stay balanced
+          while (count > 1) {
+            std::size_t n = count - 2;
+            if ((n > 0 && runs[n - 1].second <= runs[n].second + runs[n + 1].second) ||
+                (n > 1 && runs[n - 2].second <= runs[n - 1].second + runs[n].second)) {
+              if (runs[n - 1].second < runs[n + 1].second) {
+                n--;
+              }
+            } else if (runs[n].second > runs[n + 1].second) {
+              break;
+            }
+            merge_at(n);
+          }
+        }
+
+        while (count > 1) {
+          std::size_t n = count - 2;
+          if (n > 0 && runs[n - 1].second < runs[n + 1].second) {
+            n--;
+          }
+          merge_at(n);
+        }
+      }
+  }
+
+  // stable merge sort that detects ascending and descending runs (TimSort-style):
+  // O(n) on sorted or reversed inputs, close to O(n) on nearly sorted ones, O(n log n) worst case
+  // scratch is grown to at most half of the input; its capacity is kept for the next call
+  template <std::random_access_iterator It, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<It, Compare, Proj>
+    void stable_sort(It begin, It end, Vector<std::iter_value_t<It>> &scratch, Compare cmp = {}, Proj proj = {}) {
+      detail::stable_sort(begin, end, detail::projected_compare(cmp, proj), scratch);
+    }
+
+  template <std::random_access_iterator It, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<It, Compare, Proj>
+    void stable_sort(It begin, It end, Compare cmp = {}, Proj proj = {}) {
+      Vector<std::iter_value_t<It>> scratch;
+      mr::stable_sort(begin, end, scratch, std::move(cmp), std::move(proj));
+    }
+
+  template <std::ranges::random_access_range R, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Compare, Proj>
+    void stable_sort(R &range, Vector<std::ranges::range_value_t<R>> &scratch, Compare cmp = {}, Proj proj = {}) {
+      mr::stable_sort(begin(range), end(range), scratch, std::move(cmp), std::move(proj));
+    }
+
+  template <std::ranges::random_access_range R, typename Compare = std::less<>, typename Proj = std::identity>
+    requires std::sortable<std::ranges::iterator_t<R>, Compare, Proj>
+    void stable_sort(R &range, Compare cmp = {}, Proj proj = {}) {
+      mr::stable_sort(begin(range), end(range), std::move(cmp), std::move(proj));
+    }
+}
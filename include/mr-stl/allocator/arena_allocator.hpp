@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "mr-stl/def.hpp"
+
+namespace mr {
+  // monotonic (bump) arena
+  // memory is handed out linearly from heap blocks and released all at once
+  // by reset() or on destruction; only the most recent allocation can be given back
+  struct MonotonicArena {
+    static inline constexpr std::size_t default_block_size = 64 * 1024;
+
+    private:
+    struct Block {
+      Block *next = nullptr;
+      std::size_t size = 0;
+    };
+
+    Block *_blocks = nullptr;
+    std::byte *_cursor = nullptr;
+    std::byte *_end = nullptr;
+    std::byte *_last = nullptr; // start of the most recent allocation
+    std::size_t _block_size = default_block_size;
+
+    static std::byte * align_up(std::byte *ptr, std::size_t alignment) noexcept {
+      auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+      return ptr + ((alignment - addr % alignment) % alignment);
+    }
+
+    bool grow(std::size_t bytes, std::size_t alignment) noexcept {
+      std::size_t size = std::max(_block_size, bytes + alignment + sizeof(Block));
+      void *mem = std::malloc(size);
+      if (mem == nullptr) [[unlikely]] {
+        return false;
+      }
+      _blocks = new (mem) Block {_blocks, size};
+      _cursor = static_cast<std::byte *>(mem) + sizeof(Block);
+      _end = static_cast<std::byte *>(mem) + size;
+      _last = nullptr;
+      return true;
+    }
+
+    public:
+    MonotonicArena() noexcept = default;
+    explicit MonotonicArena(std::size_t block_size) noexcept :
+      _block_size(block_size) {}
+
+    MonotonicArena(const MonotonicArena &) = delete;
+    MonotonicArena & operator=(const MonotonicArena &) = delete;
+
+    ~MonotonicArena() noexcept { release(); }
+
+    void * allocate(std::size_t bytes, std::size_t alignment) noexcept {
+      std::byte *ptr = _cursor ? align_up(_cursor, alignment) : nullptr;
+      if (ptr == nullptr || ptr + bytes > _end) [[unlikely]] {
+        if (!grow(bytes, alignment)) {
+          return nullptr;
+        }
+        ptr = align_up(_cursor, alignment);
+      }
+      _last = ptr;
+      _cursor = ptr + bytes;
+      return ptr;
+    }
+
+    // the most recent allocation is extended in place while the block has room
+    void * reallocate(void *ptr, std::size_t old_bytes, std::size_t new_bytes, std::size_t alignment) noexcept {
+      if (ptr != nullptr && ptr == _last && _last + new_bytes <= _end) [[likely]] {
+        _cursor = _last + new_bytes;
+        return ptr;
+      }
+      void *tmp = allocate(new_bytes, alignment);
+      if (tmp != nullptr && ptr != nullptr) [[likely]] {
+        std::memcpy(tmp, ptr, std::min(old_bytes, new_bytes));
+      }
+      return tmp;
+    }
+
+    // bump pointer is rolled back only for the most recent allocation
+    void deallocate(void *ptr, std::size_t) noexcept {
+      if (ptr != nullptr && ptr == _last) {
+        _cursor = _last;
+        _last = nullptr;
+      }
+    }
+
+    // drop everything except the newest block, which is reused
+    void reset() noexcept {
+      if (_blocks == nullptr) {
+        return;
+      }
+      Block *head = _blocks;
+      _blocks = _blocks->next;
+      release();
+      _blocks = head;
+      head->next = nullptr;
+      _cursor = reinterpret_cast<std::byte *>(head) + sizeof(Block);
+      _end = reinterpret_cast<std::byte *>(head) + head->size;
+      _last = nullptr;
+    }
+
+    void release() noexcept {
+      while (_blocks != nullptr) {
+        Block *next = _blocks->next;
+        std::free(_blocks);
+        _blocks = next;
+      }
+      _cursor = _end = _last = nullptr;
+    }
+  };
+
+  template <typename T>
+    struct ArenaAllocator {
+      using value_type = T;
+
+      MonotonicArena *_arena = nullptr;
+
+      ArenaAllocator(MonotonicArena &arena) noexcept : _arena(&arena) {}
+      template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : _arena(other._arena) {}
+
+      T * allocate(std::size_t n) noexcept {
+        return static_cast<T *>(_arena->allocate(n * sizeof(T), alignof(T)));
+      }
+
+      T * reallocate(T *ptr, std::size_t old_n, std::size_t new_n) noexcept {
+        return static_cast<T *>(_arena->reallocate(ptr, old_n * sizeof(T), new_n * sizeof(T), alignof(T)));
+      }
+
+      void deallocate(T *ptr, std::size_t n) noexcept {
+        _arena->deallocate(ptr, n * sizeof(T));
+      }
+
+      friend bool operator==(const ArenaAllocator &lhs, const ArenaAllocator &rhs) noexcept {
+        return lhs._arena == rhs._arena;
+      }
+    };
+}
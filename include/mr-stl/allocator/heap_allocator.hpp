@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "mr-stl/def.hpp"
+
+namespace mr {
+  // default allocator of mr containers
+  // returns nullptr on failure instead of throwing (like new (std::nothrow))
+  template <typename T>
+    struct HeapAllocator {
+      using value_type = T;
+
+      static inline constexpr bool overaligned =
+        alignof(T) > alignof(std::max_align_t);
+
+      constexpr HeapAllocator() noexcept = default;
+      template <typename U>
+        constexpr HeapAllocator(const HeapAllocator<U> &) noexcept {}
+
+      T * allocate(std::size_t n) noexcept {
+        if (n == 0) [[unlikely]] {
+          return nullptr;
+        }
+        if constexpr (overaligned) {
+          // std::aligned_alloc requires size to be a multiple of alignment
+          std::size_t bytes = (n * sizeof(T) + alignof(T) - 1) & ~(alignof(T) - 1);
+          return static_cast<T *>(std::aligned_alloc(alignof(T), bytes));
+        } else {
+          return static_cast<T *>(std::malloc(n * sizeof(T)));
+        }
+      }
+
+      // realloc may grow in place (or remap pages for large blocks)
+      // aligned_alloc'ed memory cannot be realloc'ed, so over-aligned types go without it
+      // never asks for 0 bytes: realloc may then free ptr and return nullptr, which
+      // callers would take for a failure leaving ptr valid
+      T * reallocate(T *ptr, std::size_t, std::size_t n) noexcept requires (!overaligned) {
+        return static_cast<T *>(std::realloc(ptr, std::max<std::size_t>(n, 1) * sizeof(T)));
+      }
+
+      void deallocate(T *ptr, std::size_t) noexcept {
+        std::free(ptr);
+      }
+
+      friend constexpr bool operator==(const HeapAllocator &, const HeapAllocator &) noexcept {
+        return true;
+      }
+    };
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "mr-stl/def.hpp"
+
+namespace mr {
+  // pool of equally sized blocks carved out of a single slab
+  // requests not fitting into a block (or made while the pool is exhausted)
+  // are forwarded to the heap
+  struct FixedPool {
+    private:
+    struct FreeNode {
+      FreeNode *next;
+    };
+
+    static inline constexpr std::size_t block_alignment = alignof(std::max_align_t);
+
+    std::byte *_slab = nullptr;
+    FreeNode *_free = nullptr;
+    std::size_t _block_size = 0;
+    std::size_t _block_count = 0;
+
+    bool owns(const void *ptr) const noexcept {
+      auto p = static_cast<const std::byte *>(ptr);
+      return p >= _slab && p < _slab + _block_size * _block_count;
+    }
+
+    public:
+    FixedPool(std::size_t block_size, std::size_t block_count) noexcept {
+      // every block has to hold a free list node and keep max alignment
+      block_size = std::max(block_size, sizeof(FreeNode));
+      block_size = (block_size + block_alignment - 1) & ~(block_alignment - 1);
+
+      _slab = static_cast<std::byte *>(std::malloc(block_size * block_count));
+      if (_slab == nullptr) [[unlikely]] {
+        return;
+      }
+      _block_size = block_size;
+      _block_count = block_count;
+
+      for (std::size_t i = block_count; i > 0; i--) {
+        _free = new (_slab + (i - 1) * block_size) FreeNode {_free};
+      }
+    }
+
+    FixedPool(const FixedPool &) = delete;
+    FixedPool & operator=(const FixedPool &) = delete;
+
+    ~FixedPool() noexcept { std::free(_slab); }
+
+    void * allocate(std::size_t bytes, std::size_t alignment) noexcept {
+      if (bytes <= _block_size && alignment <= block_alignment && _free != nullptr) [[likely]] {
+        FreeNode *node = _free;
+        _free = node->next;
+        return node;
+      }
+      return std::malloc(bytes);
+    }
+
+    void * reallocate(void *ptr, std::size_t old_bytes, std::size_t new_bytes, std::size_t alignment) noexcept {
+      if (ptr == nullptr) [[unlikely]] {
+        return allocate(new_bytes, alignment);
+      }
+      if (owns(ptr)) {
+        if (new_bytes <= _block_size) {
+          return ptr; // block already has room
+        }
+      } else if (new_bytes > _block_size) {
+        return std::realloc(ptr, new_bytes); // heap to heap
+      }
+      void *tmp = allocate(new_bytes, alignment);
+      if (tmp != nullptr) [[likely]] {
+        std::memcpy(tmp, ptr, std::min(old_bytes, new_bytes));
+        deallocate(ptr, old_bytes);
+      }
+      return tmp;
+    }
+
+    void deallocate(void *ptr, std::size_t) noexcept {
+      if (ptr == nullptr) {
+        return;
+      }
+      if (owns(ptr)) [[likely]] {
+        _free = new (ptr) FreeNode {_free};
+      } else {
+        std::free(ptr);
+      }
+    }
+
+    std::size_t block_size() const noexcept { return _block_size; }
+    std::size_t block_count() const noexcept { return _block_count; }
+  };
+
+  template <typename T>
+    struct PoolAllocator {
+      using value_type = T;
+
+      static_assert(alignof(T) <= alignof(std::max_align_t),
+          "PoolAllocator does not support over-aligned types");
+
+      FixedPool *_pool = nullptr;
+
+      PoolAllocator(FixedPool &pool) noexcept : _pool(&pool) {}
+      template <typename U>
+        PoolAllocator(const PoolAllocator<U> &other) noexcept : _pool(other._pool) {}
+
+      T * allocate(std::size_t n) noexcept {
+        return static_cast<T *>(_pool->allocate(n * sizeof(T), alignof(T)));
+      }
+
+      T * reallocate(T *ptr, std::size_t old_n, std::size_t new_n) noexcept {
+        return static_cast<T *>(_pool->reallocate(ptr, old_n * sizeof(T), new_n * sizeof(T), alignof(T)));
+      }
+
+      void deallocate(T *ptr, std::size_t n) noexcept {
+        _pool->deallocate(ptr, n * sizeof(T));
+      }
+
+      friend bool operator==(const PoolAllocator &lhs, const PoolAllocator &rhs) noexcept {
+        return lhs._pool == rhs._pool;
+      }
+    };
+}
@@ -1,6 +1,7 @@
 #ifndef __def_hpp__
 #define __def_hpp__
 
+#include <version>
 #include <functional>
 #if __cpp_lib_span >= 202002L
 #include <span>
@@ -14,6 +15,20 @@
 #include <memory>
 
 namespace mr {
+  // types whose objects can be moved to a new address with a plain memcpy
+  // (specialize for types that are safe to relocate despite non-trivial special members)
+  template <typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+  template <typename T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+  // storage policies of owning buffers
+  // initialized:   every slot holds a live object for the whole buffer lifetime (like new T[n])
+  // uninitialized: raw memory, element lifetime is managed by the owner of the buffer
+  struct initialized_storage_t {};
+  struct uninitialized_storage_t {};
+
   template <typename T>
     concept Range = requires (T a) {
       begin(a);
@@ -27,6 +42,7 @@ namespace mr {
     };
 
   template <Range R, typename Compare>
+    requires std::is_invocable_v<Compare &, decltype(*begin(std::declval<R &>()))>
     bool contains(R range, Compare cmp) {
       for (auto elem : range) {
         if (cmp(elem)) {
@@ -67,9 +83,9 @@ namespace mr {
   template <typename S, typename R, typename ...Args>
     auto bind_self(R (S::* f)(Args...), S* self) { return std::bind_front(f, self); }
 
-  template <template <typename> typename Range, typename T>
+  template <template <typename...> typename Range, typename T, typename ...Ts>
     struct FlatRangeMethods {
-      using RangeT = Range<T>;
+      using RangeT = Range<T, Ts...>;
 
       friend T * begin(RangeT &self) noexcept {
         return self.data();
@@ -96,9 +112,9 @@ namespace mr {
       }
     };
 
-  template <template <typename> typename Range, typename T>
+  template <template <typename...> typename Range, typename T, typename ...Ts>
     struct RangeOutputOperators {
-      using RangeT = Range<T>;
+      using RangeT = Range<T, Ts...>;
 
       friend std::ostream & operator<<(std::ostream &out, const RangeT &range) {
         for (const T &elem : range) {
@@ -1,11 +1,183 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <variant>
+
+#include "mr-stl/algorithm/algorithm.hpp"
+#include "mr-stl/hashmap/hashmap.hpp"
+#include "mr-stl/thread/thread_pool.hpp"
 #include "mr-stl/vector/vector.hpp"
 // #include "mr-stl/vector/amortized_vector.hpp"
 
 namespace mr {
-  template <typename T>
+  namespace detail {
+    // node values a Graph can index: std::hash or the node's own T::Hash
+    template <typename T>
+      concept GraphIndexable = std::is_invocable_v<std::hash<T>, const T &> ||
+        requires (const T &value) { { typename T::Hash {}(value) } -> std::convertible_to<std::size_t>; };
+  }
+
+  // reusable buffers for Graph path queries, one per thread: a query touches only the
+  // nodes it reaches (visit marks are stamped with a per-query epoch instead of cleared),
+  // and buffers keep their capacity between queries
+  template <typename Distance = std::size_t>
+    struct PathScratch {
+      mr::Vector<std::uint32_t> stamps;      // node reached from src iff stamps[node] == epoch
+      mr::Vector<std::uint32_t> back_stamps; // node reached from dest (bidirectional search)
+      mr::Vector<std::size_t> parents;
+      mr::Vector<std::size_t> back_parents;
+      mr::Vector<Distance> distances;
+      mr::Vector<std::size_t> queue;
+      mr::Vector<std::size_t> back_queue;
+      mr::Vector<std::pair<Distance, std::size_t>> heap;
+      std::uint32_t epoch = 0;
+
+      static inline constexpr std::size_t heap_arity = 4;
+
+      void prepare(std::size_t nodes) {
+        if (stamps.size() < nodes) {
+          stamps.resize(nodes, 0);
+          back_stamps.resize(nodes, 0);
+          parents.resize(nodes, 0);
+          back_parents.resize(nodes, 0);
+          distances.resize(nodes, Distance {});
+        }
+        if (++epoch == 0) [[unlikely]] {
+          std::fill_n(stamps.data(), stamps.size(), 0);
+          std::fill_n(back_stamps.data(), back_stamps.size(), 0);
+          epoch = 1;
+        }
+      }
+
+      bool visited(std::size_t node) const noexcept { return stamps[node] == epoch; }
+      bool visited_back(std::size_t node) const noexcept { return back_stamps[node] == epoch; }
+
+      void visit(std::size_t node, std::size_t parent) noexcept {
+        stamps[node] = epoch;
+        parents[node] = parent;
+      }
+
+      void visit_back(std::size_t node, std::size_t parent) noexcept {
+        back_stamps[node] = epoch;
+        back_parents[node] = parent;
+      }
+
+      // cost found by the last weighted query: exact for its dest, an upper bound for
+      // other reached nodes since the search stops once dest is settled
+      std::optional<Distance> distance(std::size_t node) const noexcept {
+        if (node >= stamps.size() || !visited(node)) {
+          return std::nullopt;
+        }
+        return distances[node];
+      }
+
+      // d-ary min-heap on distance: shallower than a binary heap, and the children
+      // of a node share a cache line
+      void heap_push(Distance distance, std::size_t node) {
+        std::size_t i = heap.size();
+        heap.emplace_back(distance, node);
+        while (i > 0) {
+          const std::size_t parent = (i - 1) / heap_arity;
+          if (!(distance < heap[parent].first)) {
+            break;
+          }
+          heap[i] = heap[parent];
+          i = parent;
+        }
+        heap[i] = {distance, node};
+      }
+
+      std::pair<Distance, std::size_t> heap_pop() {
+        const auto top = heap[0];
+        const auto last = heap[heap.size() - 1];
+        heap.resize(heap.size() - 1);
+        const std::size_t size = heap.size();
+        std::size_t i = 0;
+        while (true) {
+          const std::size_t first = i * heap_arity + 1;
+          if (first >= size) {
+            break;
+          }
+          std::size_t best = first;
+          for (std::size_t child = first + 1; child < std::min(first + heap_arity, size); ++child) {
+            if (heap[child].first < heap[best].first) {
+              best = child;
+            }
+          }
+          if (!(heap[best].first < last.first)) {
+            break;
+          }
+          heap[i] = heap[best];
+          i = best;
+        }
+        if (size > 0) {
+          heap[i] = last;
+        }
+        return top;
+      }
+    };
+
+  // children of a node in a graph with edge properties: the destination and property
+  // columns side by side, iterated as (destination, property) pairs
+  template <typename Destination, typename Property>
+    struct EdgeSpan {
+      using value_type = std::pair<Destination, const Property &>;
+
+      struct Iterator {
+        using value_type = EdgeSpan::value_type;
+        using difference_type = std::ptrdiff_t;
+
+        const Destination *destination = nullptr;
+        const Property *property = nullptr;
+
+        value_type operator*() const noexcept { return {*destination, *property}; }
+
+        Iterator & operator++() noexcept {
+          ++destination;
+          ++property;
+          return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+          Iterator tmp = *this;
+          ++*this;
+          return tmp;
+        }
+
+        bool operator==(const Iterator &other) const noexcept { return destination == other.destination; }
+      };
+
+    private:
+      const Destination *_destinations = nullptr;
+      const Property *_properties = nullptr;
+      std::size_t _size = 0;
+
+    public:
+      EdgeSpan() noexcept = default;
+
+      EdgeSpan(const Destination *destinations, const Property *properties, std::size_t size) noexcept :
+        _destinations(destinations), _properties(properties), _size(size) {}
+
+      std::size_t size() const noexcept { return _size; }
+      bool empty() const noexcept { return _size == 0; }
+
+      value_type operator[](std::size_t i) const noexcept { return {_destinations[i], _properties[i]}; }
+
+      Iterator begin() const noexcept { return {_destinations, _properties}; }
+      Iterator end() const noexcept { return {_destinations + _size, _properties + _size}; }
+
+      std::span<const Destination> destinations() const noexcept { return {_destinations, _size}; }
+      std::span<const Property> properties() const noexcept { return {_properties, _size}; }
+    };
+
+  // directed graph in CSR layout: the children of node i are
+  // _destinations[_destinations_lookup[i] .. _destinations_lookup[i + 1]).
+  // a non-void EdgeProperty (weight, label, ...) adds a column parallel to _destinations
+  template <typename T, typename EdgeProperty = void>
     class Graph {
     public:
       using Node = T;
@@ -13,13 +185,185 @@ namespace mr {
       using Edge = std::pair<Destination, Destination>;
       using Path = mr::Vector<Node>;
 
+      static inline constexpr bool has_properties = !std::is_void_v<EdgeProperty>;
+      // property arguments of graphs without properties are std::monostate and ignored
+      using Property = std::conditional_t<has_properties, EdgeProperty, std::monostate>;
+      using Children = std::conditional_t<has_properties, EdgeSpan<Destination, Property>, std::span<const Destination>>;
+
+      static inline constexpr bool indexable = detail::GraphIndexable<Node>;
+
     private:
       mr::Vector<Destination> _destinations;
       mr::Vector<Destination> _destinations_lookup;
       mr::Vector<Node> _nodes;
+      [[no_unique_address]] std::conditional_t<has_properties, mr::Vector<Property>, std::monostate> _properties;
+      // node value -> id of its first occurrence, when index_nodes() was called
+      [[no_unique_address]] std::conditional_t<indexable, mr::HashMap<Node, std::size_t>, std::monostate> _index;
+      bool _indexed = false;
+      bool _index_duplicates = false; // some value is held by more than one node
+
+      // edges (or nodes) per parallel chunk when building
+      static inline constexpr std::size_t parallel_build_grain = 1 << 16;
+
+      std::span<const Destination> children(std::size_t node) const noexcept {
+        return {_destinations.data() + _destinations_lookup[node],
+                _destinations_lookup[node + 1] - _destinations_lookup[node]};
+      }
+
+      // drops repeated children of one node keeping first occurrences (and their
+      // properties) in order, returns the new end; short lists are checked pairwise,
+      // long ones through a sorted copy
+      static Destination * unique_children(Destination *first, Destination *last, Property *properties,
+                                           mr::Vector<std::pair<Destination, std::size_t>> &scratch) {
+        constexpr Destination removed = std::numeric_limits<Destination>::max();
+        if (last - first > 32) {
+          scratch.clear();
+          for (Destination *it = first; it != last; ++it) {
+            scratch.emplace_back(*it, it - first);
+          }
+          mr::sort(scratch);
+          for (std::size_t i = 1; i < scratch.size(); ++i) {
+            if (scratch[i].first == scratch[i - 1].first) {
+              first[scratch[i].second] = removed;
+            }
+          }
+        }
+        Destination *write = first;
+        for (Destination *it = first; it != last; ++it) {
+          const bool keep = last - first > 32 ? *it != removed : std::find(first, write, *it) == write;
+          if (keep) {
+            if constexpr (has_properties) {
+              properties[write - first] = std::move(properties[it - first]);
+            }
+            *write++ = *it;
+          }
+        }
+        return write;
+      }
+
+      // src, ..., node along the search tree of the last query
+      template <typename Distance>
+        Path tree_path(std::size_t src, std::size_t node, const PathScratch<Distance> &scratch) const {
+          Path path;
+          for (; node != src; node = scratch.parents[node]) {
+            path.emplace_back(_nodes[node]);
+          }
+          path.emplace_back(_nodes[src]);
+          mr::reverse(path);
+          return path;
+        }
+
+      // fills scratch.parents on the way, true if dest is reachable
+      template <typename Distance>
+        bool bfs(std::size_t src, std::size_t dest, PathScratch<Distance> &scratch) const {
+          if (src >= _nodes.size() || dest >= _nodes.size()) {
+            return false;
+          }
+          scratch.prepare(_nodes.size());
+          scratch.visit(src, src);
+          scratch.queue.clear().emplace_back(src);
+          for (std::size_t head = 0; head < scratch.queue.size() && !scratch.visited(dest); ++head) {
+            const std::size_t node = scratch.queue[head];
+            for (auto child : children(node)) {
+              if (!scratch.visited(child)) {
+                scratch.visit(child, node);
+                scratch.queue.emplace_back(child);
+              }
+            }
+          }
+          return scratch.visited(dest);
+        }
+
+      // edge_weight(node, edge) is the cost of _destinations[edge], a child of node
+      template <typename Distance, typename EdgeWeightFn>
+        bool dijkstra(std::size_t src, std::size_t dest, EdgeWeightFn &&edge_weight, PathScratch<Distance> &scratch) const {
+          if (src >= _nodes.size() || dest >= _nodes.size()) {
+            return false;
+          }
+          scratch.prepare(_nodes.size());
+          scratch.visit(src, src);
+          scratch.distances[src] = Distance {};
+          scratch.heap.clear();
+          scratch.heap_push(Distance {}, src);
+          // stale entries stay in the heap and are skipped when popped (lazy deletion)
+          while (scratch.heap.size() > 0) {
+            const auto [distance, node] = scratch.heap_pop();
+            if (scratch.distances[node] < distance) {
+              continue;
+            }
+            if (node == dest) {
+              return true;
+            }
+            for (std::size_t edge = _destinations_lookup[node]; edge < _destinations_lookup[node + 1]; ++edge) {
+              const Destination child = _destinations[edge];
+              const Distance through = distance + static_cast<Distance>(edge_weight(node, edge));
+              if (!scratch.visited(child) || through < scratch.distances[child]) {
+                scratch.visit(child, node);
+                scratch.distances[child] = through;
+                scratch.heap_push(through, child);
+              }
+            }
+          }
+          return false;
+        }
+
+      // expands whole levels of the smaller side; a node seen by both sides is returned
+      // as the meeting point. the first meeting is optimal: no frontier node was seen by
+      // the other side yet, so every meeting in the level lies on the other side's
+      // current frontier and all of them give paths of the same length
+      std::optional<std::size_t> bidirectional_bfs(std::size_t src, std::size_t dest, const Graph &reversed,
+                                                   PathScratch<> &scratch) const {
+        if (src >= _nodes.size() || dest >= _nodes.size() || reversed._nodes.size() != _nodes.size()) {
+          return std::nullopt;
+        }
+        scratch.prepare(_nodes.size());
+        scratch.visit(src, src);
+        scratch.visit_back(dest, dest);
+        if (src == dest) {
+          return src;
+        }
+        scratch.queue.clear().emplace_back(src);
+        scratch.back_queue.clear().emplace_back(dest);
+        std::size_t head = 0, back_head = 0;
+        while (head < scratch.queue.size() && back_head < scratch.back_queue.size()) {
+          const bool forward = scratch.queue.size() - head <= scratch.back_queue.size() - back_head;
+          const Graph &graph = forward ? *this : reversed;
+          auto &queue = forward ? scratch.queue : scratch.back_queue;
+          std::size_t &level_head = forward ? head : back_head;
+          for (const std::size_t level_end = queue.size(); level_head < level_end; ++level_head) {
+            const std::size_t node = queue[level_head];
+            for (auto child : graph.children(node)) {
+              if (forward ? scratch.visited(child) : scratch.visited_back(child)) {
+                continue;
+              }
+              forward ? scratch.visit(child, node) : scratch.visit_back(child, node);
+              if (forward ? scratch.visited_back(child) : scratch.visited(child)) {
+                return child;
+              }
+              queue.emplace_back(child);
+            }
+          }
+        }
+        return std::nullopt;
+      }
+
+      // records id as the first node holding its value, unless a smaller id holds it
+      void index_node(std::size_t id) requires (indexable) {
+        if (std::size_t *first = _index.try_emplace(_nodes[id], id); first != nullptr && *first != id) {
+          _index_duplicates = true;
+          *first = std::min(*first, id);
+        }
+      }
 
     public:
+      // O(1) with an index, a scan of the nodes otherwise
       std::optional<std::size_t> find(const T &node) const {
+        if constexpr (indexable) {
+          if (_indexed) {
+            const std::size_t *id = _index.find(node);
+            return id != nullptr ? std::optional(*id) : std::nullopt;
+          }
+        }
         for (std::size_t i = 0; i < _nodes.size(); ++i) {
           if (_nodes[i] == node) {
             return i;
@@ -28,6 +372,56 @@ namespace mr {
         return std::nullopt;
       }
 
+      // find for every value; without an index the values are hashed and the nodes
+      // scanned once, O(V + n) instead of O(V * n)
+      mr::Vector<std::optional<std::size_t>> find_many(std::span<const Node> values) const {
+        mr::Vector<std::optional<std::size_t>> result;
+        result.resize(values.size());
+        if constexpr (indexable) {
+          if (!_indexed) {
+            mr::HashMap<Node, std::size_t> first; // value -> its first position in values
+            first.reserve(values.size());
+            bool hashed = true;
+            for (std::size_t i = 0; hashed && i < values.size(); ++i) {
+              hashed = first.try_emplace(values[i], i) != nullptr;
+            }
+            // out of memory: fall back to a plain find per value
+            if (hashed) [[likely]] {
+              std::size_t remaining = first.size();
+              for (std::size_t id = 0; id < _nodes.size() && remaining != 0; ++id) {
+                if (const std::size_t *i = first.find(_nodes[id]); i != nullptr && !result[*i]) {
+                  result[*i] = id;
+                  --remaining;
+                }
+              }
+              for (std::size_t i = 0; i < values.size(); ++i) {
+                result[i] = result[*first.find(values[i])];
+              }
+              return result;
+            }
+          }
+        }
+        for (std::size_t i = 0; i < values.size(); ++i) {
+          result[i] = find(values[i]);
+        }
+        return result;
+      }
+
+      // builds the value -> id index (O(V)) used by find, find_many and node_children;
+      // add_node and set_node keep it up to date, from_edges and GraphBuilder results
+      // start without one
+      Graph &index_nodes() requires (indexable) {
+        _index.clear().reserve(_nodes.size());
+        _index_duplicates = false;
+        for (std::size_t id = 0; id < _nodes.size(); ++id) {
+          index_node(id);
+        }
+        _indexed = true;
+        return *this;
+      }
+
+      bool indexed() const noexcept { return _indexed; }
+
       template <typename Fn> requires (std::is_invocable_v<Fn, Node>)
       std::optional<std::size_t> find_if(Fn &&f) const {
         for (std::size_t i = 0; i < _nodes.size(); ++i) {
@@ -38,7 +432,8 @@ namespace mr {
         return std::nullopt;
       }
 
-      std::optional<std::span<const Destination>> node_children(Destination node_dest) const {
+      // destinations, or (destination, property) pairs in graphs with edge properties
+      std::optional<Children> node_children(Destination node_dest) const {
         if (node_dest + 1 >= _destinations_lookup.size()) {
           return std::nullopt;
         }
@@ -47,48 +442,150 @@ namespace mr {
         if (start > end || end > _destinations.size()) {
           return std::nullopt;
         }
-        return std::span<const Destination>(_destinations.data() + start, end - start);
+        if constexpr (has_properties) {
+          return Children(_destinations.data() + start, _properties.data() + start, end - start);
+        } else {
+          return Children(_destinations.data() + start, end - start);
+        }
       }
 
-      std::optional<std::span<const Destination>> node_children(const Node &node_val) const {
+      std::optional<Children> node_children(const Node &node_val) const {
         return find(node_val).and_then([this](auto dest) { return node_children(dest); });
       }
 
-      std::optional<Path> find_path_reversed(std::size_t src, std::size_t dest) const {
-        if (src >= _nodes.size() || dest >= _nodes.size()) {
+      // unweighted shortest path by BFS, nodes from dest back to src
+      std::optional<Path> find_path_reversed(std::size_t src, std::size_t dest, PathScratch<> &scratch) const {
+        if (!bfs(src, dest, scratch)) {
           return std::nullopt;
         }
-        if (src == dest) {
-          return Path{_nodes[src]};
+        Path path;
+        for (std::size_t node = dest; node != src; node = scratch.parents[node]) {
+          path.emplace_back(_nodes[node]);
         }
+        path.emplace_back(_nodes[src]);
+        return path;
+      }
 
-        auto children_opt = node_children(src);
-        if (!children_opt) {
+      std::optional<Path> find_path_reversed(std::size_t src, std::size_t dest) const {
+        PathScratch<> scratch;
+        return find_path_reversed(src, dest, scratch);
+      }
+
+      // unweighted shortest path by BFS; pass the same scratch to many queries
+      // to skip per-query allocation
+      std::optional<Path> find_path(std::size_t src, std::size_t dest, PathScratch<> &scratch) const {
+        auto tmp = find_path_reversed(src, dest, scratch);
+        if (tmp) {
+          mr::reverse(*tmp);
+        }
+        return tmp;
+      }
+
+      std::optional<Path> find_path(std::size_t src, std::size_t dest) const {
+        PathScratch<> scratch;
+        return find_path(src, dest, scratch);
+      }
+
+      // weighted shortest path by Dijkstra over a 4-ary heap;
+      // weight(from, to) gives the non-negative cost of the edge from -> to,
+      // scratch.distance(dest) holds the total cost afterwards
+      template <typename Distance, typename WeightFn>
+        requires (std::is_invocable_r_v<Distance, WeightFn, std::size_t, std::size_t>)
+      std::optional<Path> find_path_weighted(std::size_t src, std::size_t dest, WeightFn &&weight,
+                                             PathScratch<Distance> &scratch) const {
+        auto edge_weight = [&](std::size_t node, std::size_t edge) { return weight(node, _destinations[edge]); };
+        if (!dijkstra(src, dest, edge_weight, scratch)) {
           return std::nullopt;
         }
-        auto &children = *children_opt;
+        return tree_path(src, dest, scratch);
+      }
 
-        std::optional<Path> shortest_path = std::nullopt;
-        for (auto child : children) {
-          auto tmp = find_path_reversed(child, dest);
-          if (tmp.has_value() &&
-              !shortest_path || tmp->size() + 1 < shortest_path->size()) {
-            shortest_path = std::move(tmp);
-            shortest_path->emplace_back(_nodes[src]);
-          }
+      template <typename WeightFn>
+        requires (std::is_invocable_v<WeightFn, std::size_t, std::size_t>)
+      std::optional<Path> find_path_weighted(std::size_t src, std::size_t dest, WeightFn &&weight) const {
+        PathScratch<std::remove_cvref_t<std::invoke_result_t<WeightFn, std::size_t, std::size_t>>> scratch;
+        return find_path_weighted(src, dest, weight, scratch);
+      }
+
+      // weighted shortest path over the edge property column: the cost of an edge is
+      // proj(property), e.g. the property itself or a member like &Road::minutes
+      template <typename Distance, typename Proj>
+        requires (has_properties && std::is_invocable_v<Proj, const Property &> &&
+                  !std::is_invocable_v<Proj, std::size_t, std::size_t>)
+      std::optional<Path> find_path_weighted(std::size_t src, std::size_t dest, Proj proj,
+                                             PathScratch<Distance> &scratch) const {
+        auto edge_weight = [&](std::size_t, std::size_t edge) { return std::invoke(proj, _properties[edge]); };
+        if (!dijkstra(src, dest, edge_weight, scratch)) {
+          return std::nullopt;
         }
+        return tree_path(src, dest, scratch);
+      }
 
-        return shortest_path;
+      // the properties themselves are the costs
+      template <typename Distance>
+        requires (has_properties)
+      std::optional<Path> find_path_weighted(std::size_t src, std::size_t dest, PathScratch<Distance> &scratch) const {
+        return find_path_weighted(src, dest, std::identity {}, scratch);
       }
 
-      std::optional<Path> find_path(std::size_t src, std::size_t dest) const {
-        auto tmp = find_path_reversed(src, dest);
-        if (tmp) {
-          mr::reverse(*tmp);
+      template <typename Proj = std::identity>
+        requires (has_properties && std::is_invocable_v<Proj, const Property &> &&
+                  !std::is_invocable_v<Proj, std::size_t, std::size_t>)
+      std::optional<Path> find_path_weighted(std::size_t src, std::size_t dest, Proj proj = {}) const {
+        PathScratch<std::remove_cvref_t<std::invoke_result_t<Proj, const Property &>>> scratch;
+        return find_path_weighted(src, dest, proj, scratch);
+      }
+
+      // unweighted shortest path by BFS from both ends, expanding the smaller frontier;
+      // visits ~2 * b^(d/2) nodes instead of b^d. reversed must be transposed() of this graph
+      std::optional<Path> find_path_bidirectional(std::size_t src, std::size_t dest, const Graph &reversed,
+                                                  PathScratch<> &scratch) const {
+        const auto meet = bidirectional_bfs(src, dest, reversed, scratch);
+        if (!meet) {
+          return std::nullopt;
         }
-        return tmp;
+        Path path = tree_path(src, *meet, scratch);
+        for (std::size_t node = *meet; node != dest;) {
+          node = scratch.back_parents[node];
+          path.emplace_back(_nodes[node]);
+        }
+        return path;
+      }
+
+      // same nodes with every edge (and its property) reversed, built in O(V + E)
+      Graph transposed() const {
+        Graph result;
+        result._nodes = _nodes;
+        if constexpr (indexable) {
+          if (_indexed) {
+            result.index_nodes();
+          }
+        }
+        result._destinations_lookup.resize(_nodes.size() + 1, 0);
+        for (std::size_t i = 0; i < _destinations.size(); ++i) {
+          ++result._destinations_lookup[_destinations[i] + 1];
+        }
+        for (std::size_t i = 1; i < result._destinations_lookup.size(); ++i) {
+          result._destinations_lookup[i] += result._destinations_lookup[i - 1];
+        }
+        result._destinations.resize(_destinations.size());
+        if constexpr (has_properties) {
+          result._properties.resize(_properties.size());
+        }
+        mr::Vector<Destination> cursor = result._destinations_lookup;
+        for (std::size_t src = 0; src < _nodes.size(); ++src) {
+          for (std::size_t i = _destinations_lookup[src]; i < _destinations_lookup[src + 1]; ++i) {
+            const std::size_t pos = cursor[_destinations[i]]++;
+            result._destinations[pos] = src;
+            if constexpr (has_properties) {
+              result._properties[pos] = _properties[i];
+            }
+          }
+        }
+        return result;
       }
 
+      // predicates scan the nodes; known values are faster through find and find_path(src, dest)
       template <typename Fn1, typename Fn2>
         requires (std::is_invocable_v<Fn1, Node> && std::is_invocable_v<Fn2, Node>)
       std::optional<Path> find_path(Fn1 &&f1, Fn2 &&f2) const {
@@ -100,9 +597,211 @@ namespace mr {
         return find_path(*src, *dest);
       }
 
+      // bulk CSR construction in O(V + E): out-degrees are counted, prefix-summed into
+      // the lookup and destinations scattered in edge order. the result equals calling
+      // add_edge for every edge: out of range and repeated edges are dropped, children
+      // keep input order. properties[i] belongs to edges[i] (missing ones are
+      // value-initialized), graphs without edge properties ignore them
+      static Graph from_edges(mr::Vector<Node> nodes, std::span<const Edge> edges,
+                              std::span<const Property> properties = {}) {
+        Graph graph;
+        const std::size_t node_count = nodes.size();
+        graph._nodes = std::move(nodes);
+        auto &lookup = graph._destinations_lookup;
+        auto &destinations = graph._destinations;
+
+        lookup.resize(node_count + 1, 0);
+        for (auto [src, dest] : edges) {
+          if (src < node_count && dest < node_count) {
+            ++lookup[src + 1];
+          }
+        }
+        for (std::size_t i = 1; i <= node_count; ++i) {
+          lookup[i] += lookup[i - 1];
+        }
+
+        destinations.resize(lookup[node_count]);
+        if constexpr (has_properties) {
+          graph._properties.resize(lookup[node_count]);
+        }
+        mr::Vector<Destination> cursor = lookup;
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+          if (const auto [src, dest] = edges[i]; src < node_count && dest < node_count) {
+            const std::size_t pos = cursor[src]++;
+            destinations[pos] = dest;
+            if constexpr (has_properties) {
+              graph._properties[pos] = i < properties.size() ? properties[i] : Property {};
+            }
+          }
+        }
+
+        // drop repeats in place: cursor now remembers the last node that listed a child
+        std::fill_n(cursor.data(), node_count, node_count);
+        std::size_t write = 0;
+        for (std::size_t node = 0; node < node_count; ++node) {
+          const std::size_t begin = lookup[node], end = lookup[node + 1];
+          lookup[node] = write;
+          for (std::size_t i = begin; i < end; ++i) {
+            if (const Destination dest = destinations[i]; cursor[dest] != node) {
+              cursor[dest] = node;
+              if constexpr (has_properties) {
+                graph._properties[write] = std::move(graph._properties[i]);
+              }
+              destinations[write++] = dest;
+            }
+          }
+        }
+        lookup[node_count] = write;
+        destinations.resize(write);
+        if constexpr (has_properties) {
+          graph._properties.resize(write);
+        }
+        return graph;
+      }
+
+      // parallel from_edges with the same result. edges are cut into chunks and nodes into
+      // as many ranges; every chunk partitions its edges by source range, then every range
+      // is laid out independently. no atomics: a locked increment before each random
+      // store serializes the cache misses and ran 13x slower than a plain scatter
+      static Graph from_edges(const parallel_policy_t &policy, mr::Vector<Node> nodes, std::span<const Edge> edges,
+                              std::span<const Property> properties = {}) {
+        ThreadPool &pool = policy.executor();
+        const std::size_t parts = std::clamp<std::size_t>(edges.size() / parallel_build_grain, 1, (pool.size() + 1) * 4);
+        if (parts == 1) {
+          return from_edges(std::move(nodes), edges, properties);
+        }
+
+        Graph graph;
+        const std::size_t node_count = nodes.size();
+        graph._nodes = std::move(nodes);
+        auto &lookup = graph._destinations_lookup;
+        lookup.resize(node_count + 1, 0);
+
+        const std::size_t range_size = node_count / parts + 1;
+        auto chunk_begin = [&](std::size_t part) { return edges.size() * part / parts; };
+        auto for_each_part = [&](auto fn) {
+          parallel_for(policy.on(pool), 0, parts, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t part = begin; part < end; ++part) {
+              fn(part);
+            }
+          });
+        };
+
+        // offsets[chunk * parts + range]: where the chunk's edges out of the range go,
+        // ranges in order and chunks in order within a range, so edge order is kept
+        mr::Vector<std::size_t> offsets;
+        offsets.resize(parts * parts, 0);
+        for_each_part([&](std::size_t part) {
+          for (std::size_t i = chunk_begin(part); i < chunk_begin(part + 1); ++i) {
+            if (const auto [src, dest] = edges[i]; src < node_count && dest < node_count) {
+              ++offsets[part * parts + src / range_size];
+            }
+          }
+        });
+        mr::Vector<std::size_t> range_begin;
+        range_begin.resize(parts + 1, 0);
+        std::size_t total = 0;
+        for (std::size_t range = 0; range < parts; ++range) {
+          range_begin[range] = total;
+          for (std::size_t part = 0; part < parts; ++part) {
+            total += std::exchange(offsets[part * parts + range], total);
+          }
+        }
+        range_begin[parts] = total;
+
+        // edge indices grouped by source range
+        mr::Vector<std::size_t> partitioned;
+        partitioned.resize(total);
+        for_each_part([&](std::size_t part) {
+          std::size_t *cursor = offsets.data() + part * parts;
+          for (std::size_t i = chunk_begin(part); i < chunk_begin(part + 1); ++i) {
+            if (const auto [src, dest] = edges[i]; src < node_count && dest < node_count) {
+              partitioned[cursor[src / range_size]++] = i;
+            }
+          }
+        });
+
+        // per range: count degrees, scatter destinations, drop repeats;
+        // counts[node] ends up as the number of distinct children
+        mr::Vector<Destination> scattered;
+        scattered.resize(total);
+        std::conditional_t<has_properties, mr::Vector<Property>, std::monostate> scattered_properties;
+        if constexpr (has_properties) {
+          scattered_properties.resize(total);
+        }
+        mr::Vector<std::size_t> counts;
+        counts.resize(node_count, 0);
+        for_each_part([&](std::size_t range) {
+          const std::size_t first = std::min(range * range_size, node_count);
+          const std::size_t last = std::min(first + range_size, node_count);
+          const std::span<const std::size_t> range_edges(partitioned.data() + range_begin[range],
+                                                         range_begin[range + 1] - range_begin[range]);
+          for (std::size_t i : range_edges) {
+            ++counts[edges[i].first];
+          }
+          for (std::size_t node = first, begin = range_begin[range]; node < last; ++node) {
+            lookup[node] = begin;
+            begin += std::exchange(counts[node], begin);
+          }
+          for (std::size_t i : range_edges) {
+            const std::size_t pos = counts[edges[i].first]++;
+            scattered[pos] = edges[i].second;
+            if constexpr (has_properties) {
+              scattered_properties[pos] = i < properties.size() ? properties[i] : Property {};
+            }
+          }
+          mr::Vector<std::pair<Destination, std::size_t>> scratch;
+          for (std::size_t node = first; node < last; ++node) {
+            Destination *children = scattered.data() + lookup[node];
+            Property *children_properties = nullptr;
+            if constexpr (has_properties) {
+              children_properties = scattered_properties.data() + lookup[node];
+            }
+            counts[node] = unique_children(children, scattered.data() + counts[node], children_properties, scratch) - children;
+          }
+        });
+
+        // compact into a fresh array: a node's new range may overlap its neighbour's old one
+        std::size_t distinct = 0;
+        for (std::size_t node = 0; node < node_count; ++node) {
+          distinct += std::exchange(counts[node], distinct);
+        }
+        if (distinct == total) {
+          graph._destinations = std::move(scattered);
+          if constexpr (has_properties) {
+            graph._properties = std::move(scattered_properties);
+          }
+        } else {
+          graph._destinations.resize(distinct);
+          if constexpr (has_properties) {
+            graph._properties.resize(distinct);
+          }
+          for_each_part([&](std::size_t range) {
+            const std::size_t first = std::min(range * range_size, node_count);
+            const std::size_t last = std::min(first + range_size, node_count);
+            for (std::size_t node = first; node < last; ++node) {
+              const std::size_t count = (node + 1 < node_count ? counts[node + 1] : distinct) - counts[node];
+              std::copy_n(scattered.data() + lookup[node], count, graph._destinations.data() + counts[node]);
+              if constexpr (has_properties) {
+                std::move(scattered_properties.data() + lookup[node], scattered_properties.data() + lookup[node] + count,
+                          graph._properties.data() + counts[node]);
+              }
+            }
+          });
+        }
+        std::copy_n(counts.data(), node_count, lookup.data());
+        lookup[node_count] = distinct;
+        return graph;
+      }
+
       template <typename... Args> requires(std::is_constructible_v<T, Args...>)
       Graph &add_node(Args... args) {
         _nodes.emplace_back(std::forward<Args>(args)...);
+        if constexpr (indexable) {
+          if (_indexed) {
+            index_node(_nodes.size() - 1);
+          }
+        }
         const std::size_t required_size = _nodes.size() + 1;
         while (_destinations_lookup.size() < required_size) {
           _destinations_lookup.emplace_back(_destinations.size());
@@ -110,23 +809,26 @@ namespace mr {
         return *this;
       }
 
-      Graph &add_edge(std::size_t src, std::size_t dest) {
+      // O(E) per call: shifts every later edge. bulk loads go through from_edges or GraphBuilder
+      Graph &add_edge(std::size_t src, std::size_t dest, Property property = {}) {
         if (src >= _nodes.size() || dest >= _nodes.size()) {
           return *this;
         }
 
-        auto children_opt = node_children(src);
-        if (!children_opt) {
+        if (!node_children(src)) {
           return *this;
         }
-        auto children = *children_opt;
 
-        if (std::find(children.begin(), children.end(), dest) != children.end()) {
+        if (std::find(_destinations.data() + _destinations_lookup[src], _destinations.data() + _destinations_lookup[src + 1],
+                      dest) != _destinations.data() + _destinations_lookup[src + 1]) {
           return *this;
         }
 
         const std::size_t insert_pos = _destinations_lookup[src + 1];
         _destinations.emplace_at(insert_pos, dest);
+        if constexpr (has_properties) {
+          _properties.emplace_at(insert_pos, std::move(property));
+        }
 
         for (std::size_t i = src + 1; i < _destinations_lookup.size(); ++i) {
           ++_destinations_lookup[i];
@@ -135,7 +837,109 @@ namespace mr {
         return *this;
       }
 
-      mr::Vector<Node> &nodes() noexcept { return _nodes; }
+      // replaces the value of node id, keeping the index up to date; O(1), except
+      // that with repeated values the next holder of the old value is searched
+      Graph &set_node(std::size_t id, Node value) {
+        if (id >= _nodes.size()) {
+          return *this;
+        }
+        if constexpr (indexable) {
+          if (_indexed) {
+            if (const std::size_t *first = _index.find(_nodes[id]); first != nullptr && *first == id) {
+              _index.erase(_nodes[id]);
+              for (std::size_t other = id + 1; _index_duplicates && other < _nodes.size(); ++other) {
+                if (_nodes[other] == _nodes[id]) {
+                  _index.try_emplace(_nodes[other], other);
+                  break;
+                }
+              }
+            }
+            _nodes[id] = std::move(value);
+            index_node(id);
+            return *this;
+          }
+        }
+        _nodes[id] = std::move(value);
+        return *this;
+      }
+
       const mr::Vector<Node> &nodes() const noexcept { return _nodes; }
+
+      // raw CSR arrays for whole-graph algorithms: the children of node i are
+      // destinations()[offsets()[i] .. offsets()[i + 1]); offsets() is empty when there are no nodes
+      std::span<const Destination> offsets() const noexcept {
+        return {_destinations_lookup.data(), _nodes.size() == 0 ? 0 : _nodes.size() + 1};
+      }
+
+      std::span<const Destination> destinations() const noexcept { return {_destinations.data(), _destinations.size()}; }
+    };
+
+  // collects nodes, edges and edge properties in O(1) each, then builds the CSR graph in one pass
+  template <typename T, typename EdgeProperty = void>
+    struct GraphBuilder {
+      using Graph = mr::Graph<T, EdgeProperty>;
+      using Edge = typename Graph::Edge;
+      using Property = typename Graph::Property;
+
+    private:
+      mr::Vector<T> _nodes;
+      mr::Vector<Edge> _edges;
+      [[no_unique_address]] std::conditional_t<Graph::has_properties, mr::Vector<Property>, std::monostate> _properties;
+
+      std::span<const Property> properties() const noexcept {
+        if constexpr (Graph::has_properties) {
+          return {_properties.data(), _properties.size()};
+        } else {
+          return {};
+        }
+      }
+
+    public:
+      template <typename... Args> requires(std::is_constructible_v<T, Args...>)
+      GraphBuilder &add_node(Args... args) {
+        _nodes.emplace_back(std::forward<Args>(args)...);
+        return *this;
+      }
+
+      GraphBuilder &add_edge(std::size_t src, std::size_t dest, Property property = {}) {
+        _edges.emplace_back(src, dest);
+        if constexpr (Graph::has_properties) {
+          _properties.emplace_back(std::move(property));
+        }
+        return *this;
+      }
+
+      GraphBuilder &reserve(std::size_t nodes, std::size_t edges) {
+        _nodes.reserve(nodes);
+        _edges.reserve(edges);
+        if constexpr (Graph::has_properties) {
+          _properties.reserve(edges);
+        }
+        return *this;
+      }
+
+      std::size_t node_count() const noexcept { return _nodes.size(); }
+      std::size_t edge_count() const noexcept { return _edges.size(); }
+
+      // both leave the builder empty
+      Graph build() {
+        auto graph = Graph::from_edges(std::move(_nodes), {_edges.data(), _edges.size()}, properties());
+        clear_edges();
+        return graph;
+      }
+
+      Graph build(const parallel_policy_t &policy) {
+        auto graph = Graph::from_edges(policy, std::move(_nodes), {_edges.data(), _edges.size()}, properties());
+        clear_edges();
+        return graph;
+      }
+
+    private:
+      void clear_edges() {
+        _edges.clear();
+        if constexpr (Graph::has_properties) {
+          _properties.clear();
+        }
+      }
     };
 }  // namespace mr
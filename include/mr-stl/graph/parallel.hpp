@@ -0,0 +1,397 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <utility>
+
+#include "mr-stl/graph/graph.hpp"
+#include "mr-stl/thread/thread_pool.hpp"
+#include "mr-stl/vector/vector.hpp"
+
+namespace mr {
+  // depth of nodes bfs_depths did not reach
+  inline constexpr std::uint32_t bfs_unreached = std::numeric_limits<std::uint32_t>::max();
+
+  namespace detail {
+    // the CSR arrays of a Graph, as read by the whole-graph algorithms below
+    struct CsrView {
+      std::span<const std::size_t> offsets;
+      std::span<const std::size_t> destinations;
+
+      std::size_t node_count() const noexcept { return offsets.empty() ? 0 : offsets.size() - 1; }
+      std::size_t degree(std::size_t node) const noexcept { return offsets[node + 1] - offsets[node]; }
+
+      std::span<const std::size_t> children(std::size_t node) const noexcept {
+        return destinations.subspan(offsets[node], degree(node));
+      }
+    };
+
+    template <typename T, typename E>
+      CsrView csr(const Graph<T, E> &graph) noexcept { return {graph.offsets(), graph.destinations()}; }
+
+    // slices of at least grain indices, up to 4 per pool thread
+    inline std::size_t chunk_count(const parallel_policy_t &policy, std::size_t count, std::size_t grain) {
+      return std::clamp<std::size_t>(count / grain, 1, (policy.executor().size() + 1) * 4);
+    }
+
+    // fn(chunk, begin, end) over chunks equal slices of [0, count), in parallel
+    template <typename Fn>
+      void for_each_chunk(const parallel_policy_t &policy, std::size_t count, std::size_t chunks, Fn fn) {
+        parallel_for(policy, 0, chunks, 1, [&](std::size_t first, std::size_t last) {
+          for (std::size_t chunk = first; chunk < last; chunk++) {
+            fn(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+          }
+        });
+      }
+
+    // concatenates the first chunks buffers of parts into out, in chunk order
+    inline void concat_chunks(const parallel_policy_t &policy, const mr::Vector<mr::Vector<std::size_t>> &parts,
+                              std::size_t chunks, mr::Vector<std::size_t> &out) {
+      mr::Vector<std::size_t> starts;
+      std::size_t total = 0;
+      for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+        starts.emplace_back(total);
+        total += parts[chunk].size();
+      }
+      out.resize(total);
+      for_each_chunk(policy, chunks, chunks, [&](std::size_t chunk, std::size_t, std::size_t) {
+        std::copy_n(parts[chunk].data(), parts[chunk].size(), out.data() + starts[chunk]);
+      });
+    }
+
+    // frontier of one BFS level as a bitmap, 64 nodes per word
+    inline bool bit_test(const mr::Vector<std::uint64_t> &bits, std::size_t node) noexcept {
+      return (bits[node / 64] >> (node % 64)) & 1;
+    }
+
+    // hooks the higher of the roots of u and v under the lower one (Afforest link);
+    // comp only ever decreases, so the root of a component ends up its smallest node
+    inline void link_components(std::size_t u, std::size_t v, mr::Vector<std::size_t> &comp) noexcept {
+      auto at = [&](std::size_t node) { return std::atomic_ref<std::size_t>(comp[node]); };
+      std::size_t p1 = at(u).load(std::memory_order_relaxed);
+      std::size_t p2 = at(v).load(std::memory_order_relaxed);
+      while (p1 != p2) {
+        const std::size_t high = std::max(p1, p2), low = std::min(p1, p2);
+        std::size_t p_high = at(high).load(std::memory_order_relaxed);
+        if (p_high == low) {
+          return;
+        }
+        if (p_high == high && at(high).compare_exchange_strong(p_high, low, std::memory_order_relaxed)) {
+          return;
+        }
+        p1 = at(at(high).load(std::memory_order_relaxed)).load(std::memory_order_relaxed);
+        p2 = at(low).load(std::memory_order_relaxed);
+      }
+    }
+
+    // points every node straight at its root
+    inline void compress_components(const parallel_policy_t &policy, mr::Vector<std::size_t> &comp, std::size_t chunks) {
+      for_each_chunk(policy, comp.size(), chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+        auto at = [&](std::size_t node) { return std::atomic_ref<std::size_t>(comp[node]); };
+        for (std::size_t node = begin; node < end; node++) {
+          std::size_t parent = at(node).load(std::memory_order_relaxed);
+          for (std::size_t grand = at(parent).load(std::memory_order_relaxed); parent != grand;
+               grand = at(parent).load(std::memory_order_relaxed)) {
+            parent = grand;
+            at(node).store(parent, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+
+    // Afforest (Sutton et al.): linking the first few children of every node already
+    // joins most of a typical giant component, whose nodes then skip their remaining
+    // edges. skipping needs the edges of those nodes covered from the other end, so it
+    // is only done with in-edges (in) at hand
+    inline mr::Vector<std::size_t> afforest(const parallel_policy_t &policy, CsrView out, const CsrView *in, bool symmetric) {
+      constexpr std::size_t neighbor_rounds = 2;
+      constexpr std::size_t samples = 1024;
+
+      const std::size_t n = out.node_count();
+      mr::Vector<std::size_t> comp;
+      comp.resize(n);
+      const std::size_t chunks = chunk_count(policy, n, 1 << 12);
+      for_each_chunk(policy, n, chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t node = begin; node < end; node++) {
+          comp[node] = node;
+        }
+      });
+      if (n == 0) {
+        return comp;
+      }
+
+      for (std::size_t round = 0; round < neighbor_rounds; round++) {
+        for_each_chunk(policy, n, chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+          for (std::size_t node = begin; node < end; node++) {
+            if (round < out.degree(node)) {
+              link_components(node, out.destinations[out.offsets[node] + round], comp);
+            }
+          }
+        });
+        compress_components(policy, comp, chunks);
+      }
+
+      // most frequent root among a sample approximates the largest component
+      std::size_t largest = n;
+      if (in != nullptr) {
+        mr::HashMap<std::size_t, std::size_t> counts;
+        std::mt19937_64 rng(n);
+        std::size_t best = 0;
+        for (std::size_t i = 0; i < samples; i++) {
+          const std::size_t root = comp[rng() % n];
+          std::size_t *count = counts.try_emplace(root, 0);
+          if (count == nullptr) [[unlikely]] {
+            break; // out of memory: keep the guess from a smaller sample
+          }
+          if (++*count > best) {
+            best = *count;
+            largest = root;
+          }
+        }
+      }
+
+      for_each_chunk(policy, n, chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t node = begin; node < end; node++) {
+          if (std::atomic_ref<std::size_t>(comp[node]).load(std::memory_order_relaxed) == largest) {
+            continue;
+          }
+          for (std::size_t edge = out.offsets[node] + neighbor_rounds; edge < out.offsets[node + 1]; edge++) {
+            link_components(node, out.destinations[edge], comp);
+          }
+          if (in != nullptr && !symmetric) {
+            for (std::size_t parent : in->children(node)) {
+              link_components(node, parent, comp);
+            }
+          }
+        }
+      });
+      compress_components(policy, comp, chunks);
+      return comp;
+    }
+  }
+
+  // direction-optimizing BFS (Beamer et al.): hop count from src to every node,
+  // bfs_unreached where there is no path
+  // - small frontiers expand top-down from a queue, claiming children with a compare-exchange
+  // - once a growing frontier's edges exceed 1/15 of the unexplored ones, levels run
+  //   bottom-up: every unreached node scans its parents for one in the frontier bitmap and
+  //   stops at the first, until the frontier shrinks below 1/18 of the nodes
+  // reversed is graph.transposed(), or graph itself when every edge has its reverse;
+  // reuse it across queries
+  template <typename T, typename E>
+    mr::Vector<std::uint32_t> bfs_depths(const parallel_policy_t &policy, const Graph<T, E> &graph,
+                                         const Graph<T, E> &reversed, std::size_t src) {
+      constexpr std::size_t alpha = 15, beta = 18;
+      constexpr std::size_t queue_grain = 1 << 10; // frontier nodes per task
+      constexpr std::size_t bitmap_grain = 1 << 6; // bitmap words (64 nodes each) per task
+
+      const detail::CsrView out = detail::csr(graph), in = detail::csr(reversed);
+      const std::size_t n = out.node_count();
+      mr::Vector<std::uint32_t> depths;
+      depths.resize(n, bfs_unreached);
+      if (src >= n || in.node_count() != n) {
+        return depths;
+      }
+      depths[src] = 0;
+
+      const std::size_t words = (n + 63) / 64;
+      mr::Vector<std::uint64_t> frontier_bits, next_bits;
+      mr::Vector<std::size_t> queue, next_queue, chunk_counts, chunk_edges;
+      mr::Vector<mr::Vector<std::size_t>> chunk_nodes;
+      queue.emplace_back(src);
+
+      // out-edges of nodes not expanded yet, of the current frontier and of the one before
+      std::size_t unexplored_edges = out.destinations.size();
+      std::size_t frontier_edges = out.degree(src), previous_edges = 0;
+      for (std::uint32_t depth = 0; queue.size() > 0;) {
+        if (frontier_edges > unexplored_edges / alpha && frontier_edges > previous_edges) {
+          // queue -> bitmap
+          frontier_bits.resize(words);
+          next_bits.resize(words);
+          const std::size_t word_chunks = detail::chunk_count(policy, words, bitmap_grain);
+          detail::for_each_chunk(policy, words, word_chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+            std::fill_n(frontier_bits.data() + begin, end - begin, 0);
+          });
+          const std::size_t queue_chunks = detail::chunk_count(policy, queue.size(), queue_grain);
+          detail::for_each_chunk(policy, queue.size(), queue_chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+              std::atomic_ref<std::uint64_t>(frontier_bits[queue[i] / 64])
+                .fetch_or(std::uint64_t(1) << (queue[i] % 64), std::memory_order_relaxed);
+            }
+          });
+
+          // bottom-up levels; every task owns whole words of next_bits and their nodes' depths
+          chunk_counts.resize(word_chunks);
+          chunk_edges.resize(word_chunks);
+          std::size_t awake = queue.size(), old_awake = 0;
+          do {
+            old_awake = awake;
+            unexplored_edges -= std::min(unexplored_edges, frontier_edges);
+            detail::for_each_chunk(policy, words, word_chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+              std::size_t found = 0, edges = 0;
+              for (std::size_t word = begin; word < end; word++) {
+                std::uint64_t bits = 0;
+                for (std::size_t node = word * 64; node < std::min(n, word * 64 + 64); node++) {
+                  if (depths[node] != bfs_unreached) {
+                    continue;
+                  }
+                  for (std::size_t parent : in.children(node)) {
+                    if (detail::bit_test(frontier_bits, parent)) {
+                      depths[node] = depth + 1;
+                      bits |= std::uint64_t(1) << (node % 64);
+                      found++;
+                      edges += out.degree(node);
+                      break;
+                    }
+                  }
+                }
+                next_bits[word] = bits;
+              }
+              chunk_counts[chunk] = found;
+              chunk_edges[chunk] = edges;
+            });
+            awake = 0;
+            previous_edges = std::exchange(frontier_edges, 0);
+            for (std::size_t chunk = 0; chunk < word_chunks; chunk++) {
+              awake += chunk_counts[chunk];
+              frontier_edges += chunk_edges[chunk];
+            }
+            std::swap(frontier_bits, next_bits);
+            depth++;
+          } while (awake >= old_awake || awake > n / beta);
+
+          // bitmap -> queue
+          chunk_nodes.resize(word_chunks);
+          detail::for_each_chunk(policy, words, word_chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+            auto &nodes = chunk_nodes[chunk].clear();
+            for (std::size_t word = begin; word < end; word++) {
+              for (std::uint64_t bits = frontier_bits[word]; bits != 0; bits &= bits - 1) {
+                nodes.emplace_back(word * 64 + std::countr_zero(bits));
+              }
+            }
+          });
+          detail::concat_chunks(policy, chunk_nodes, word_chunks, queue);
+        } else {
+          // top-down level
+          unexplored_edges -= std::min(unexplored_edges, frontier_edges);
+          const std::size_t queue_chunks = detail::chunk_count(policy, queue.size(), queue_grain);
+          chunk_nodes.resize(queue_chunks);
+          chunk_counts.resize(queue_chunks);
+          detail::for_each_chunk(policy, queue.size(), queue_chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+            auto &nodes = chunk_nodes[chunk].clear();
+            std::size_t edges = 0;
+            for (std::size_t i = begin; i < end; i++) {
+              for (std::size_t child : out.children(queue[i])) {
+                std::atomic_ref<std::uint32_t> child_depth(depths[child]);
+                std::uint32_t expected = bfs_unreached;
+                if (child_depth.load(std::memory_order_relaxed) == bfs_unreached &&
+                    child_depth.compare_exchange_strong(expected, depth + 1, std::memory_order_relaxed)) {
+                  nodes.emplace_back(child);
+                  edges += out.degree(child);
+                }
+              }
+            }
+            chunk_counts[chunk] = edges;
+          });
+          previous_edges = std::exchange(frontier_edges, 0);
+          for (std::size_t chunk = 0; chunk < queue_chunks; chunk++) {
+            frontier_edges += chunk_counts[chunk];
+          }
+          detail::concat_chunks(policy, chunk_nodes, queue_chunks, next_queue);
+          std::swap(queue, next_queue);
+          depth++;
+        }
+      }
+      return depths;
+    }
+
+  // same, transposing graph first; pass a reused reversed graph for repeated queries
+  template <typename T, typename E>
+    mr::Vector<std::uint32_t> bfs_depths(const parallel_policy_t &policy, const Graph<T, E> &graph, std::size_t src) {
+      return bfs_depths(policy, graph, graph.transposed(), src);
+    }
+
+  // weakly connected components: comp[node] is the smallest node id of the component
+  // of node, edge directions ignored
+  template <typename T, typename E>
+    mr::Vector<std::size_t> connected_components(const parallel_policy_t &policy, const Graph<T, E> &graph) {
+      return detail::afforest(policy, detail::csr(graph), nullptr, false);
+    }
+
+  // same; reversed (graph.transposed(), or graph itself when every edge has its reverse)
+  // lets nodes of the largest component skip their remaining edges
+  template <typename T, typename E>
+    mr::Vector<std::size_t> connected_components(const parallel_policy_t &policy, const Graph<T, E> &graph,
+                                                 const Graph<T, E> &reversed) {
+      const detail::CsrView in = detail::csr(reversed);
+      if (in.node_count() != graph.nodes().size()) {
+        return connected_components(policy, graph);
+      }
+      return detail::afforest(policy, detail::csr(graph), &in, &reversed == &graph);
+    }
+
+  // PageRank by pull-based SpMV over the reversed graph (graph.transposed(), or graph
+  // itself when every edge has its reverse): each node sums rank / out-degree of its
+  // parents, so every rank is written by one task and no atomics are needed. ranks sum
+  // to 1, dangling nodes spread theirs over all nodes. stops after max_iterations or
+  // once an iteration changes the ranks by less than tolerance (L1)
+  template <typename T, typename E>
+    mr::Vector<double> pagerank(const parallel_policy_t &policy, const Graph<T, E> &graph, const Graph<T, E> &reversed,
+                                double damping = 0.85, std::size_t max_iterations = 20, double tolerance = 1e-4) {
+      const detail::CsrView out = detail::csr(graph), in = detail::csr(reversed);
+      const std::size_t n = out.node_count();
+      mr::Vector<double> ranks;
+      if (n == 0 || in.node_count() != n) {
+        return ranks;
+      }
+      ranks.resize(n, 1.0 / n);
+      mr::Vector<double> contributions, partial;
+      contributions.resize(n);
+      const std::size_t chunks = detail::chunk_count(policy, n, 1 << 12);
+      partial.resize(chunks);
+      auto total = [&] {
+        double sum = 0;
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+          sum += partial[chunk];
+        }
+        return sum;
+      };
+
+      for (std::size_t iteration = 0; iteration < max_iterations; iteration++) {
+        detail::for_each_chunk(policy, n, chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+          double dangling = 0;
+          for (std::size_t node = begin; node < end; node++) {
+            const std::size_t degree = out.degree(node);
+            contributions[node] = degree != 0 ? ranks[node] / degree : 0;
+            dangling += degree != 0 ? 0 : ranks[node];
+          }
+          partial[chunk] = dangling;
+        });
+        const double base = (1 - damping + damping * total()) / n;
+
+        detail::for_each_chunk(policy, n, chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+          double change = 0;
+          for (std::size_t node = begin; node < end; node++) {
+            double sum = 0;
+            for (std::size_t parent : in.children(node)) {
+              sum += contributions[parent];
+            }
+            const double rank = base + damping * sum;
+            change += std::abs(rank - ranks[node]);
+            ranks[node] = rank;
+          }
+          partial[chunk] = change;
+        });
+        if (total() < tolerance) {
+          break;
+        }
+      }
+      return ranks;
+    }
+}
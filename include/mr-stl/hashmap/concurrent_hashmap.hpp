@@ -0,0 +1,351 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "mr-stl/hashmap/hashmap.hpp"
+
+namespace mr {
+  // hash map shared between threads: lookups never lock, writers lock one shard
+  // - keys are split over Shards independent tables by the top bits of their hash
+  // - each shard is guarded by a seqlock: writers (serialized by the shard mutex) make
+  //   the version odd while they modify the table, readers copy the entry out and retry
+  //   if the version changed meanwhile, so a lookup costs two loads of a shared counter
+  // - tables use HashMap's layout and probing (control byte groups, backward shift erase)
+  //   stored as relaxed atomic words, so torn reads are retried instead of being races
+  // - tables replaced by a rehash are kept until the map is destroyed, because readers may
+  //   still be probing them (at most as much memory as the live tables, growth is 2x)
+  // readers copy entries out word by word and may see torn ones before the seqlock check
+  // rejects them, so K and V have to be trivially copyable (and default constructible)
+  // and comparing keys must not follow pointers stored in them
+  template <typename K, typename V,
+            typename Hash = std::hash<K>,
+            typename KeyEqual = std::equal_to<>,
+            std::size_t Shards = 64>
+    struct ConcurrentHashMap {
+      static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<V>,
+        "entries are read concurrently with writes and must be trivially copyable");
+      static_assert(std::has_single_bit(Shards), "shard count must be a power of two");
+
+      using key_type = K;
+      using mapped_type = V;
+      using hasher = detail::hash_t<K, Hash>;
+      using key_equal = KeyEqual;
+
+      template <typename Key>
+        static inline constexpr bool lookup_key_v =
+          std::is_same_v<std::remove_cvref_t<Key>, K> || detail::is_transparent_v<hasher, KeyEqual>;
+
+    private:
+      using Word = std::atomic<std::uint64_t>;
+
+      struct Entry {
+        K key;
+        V value;
+      };
+
+      static inline constexpr std::size_t group_width = detail::group_width;
+      static inline constexpr std::size_t entry_words = (sizeof(Entry) + 7) / 8;
+      static inline constexpr std::size_t shard_bits = std::countr_zero(Shards);
+
+      // capacity is a power of two >= group_width; like in HashMap the first
+      // group_width - 1 control bytes are cloned after the last one
+      struct Table {
+        std::size_t capacity = 0;
+        std::unique_ptr<Word[]> ctrl;
+        std::unique_ptr<Word[]> entries;
+
+        explicit Table(std::size_t slots) noexcept :
+          capacity(slots),
+          ctrl(new (std::nothrow) Word[(slots + group_width) / 8 + 1]),
+          entries(new (std::nothrow) Word[slots * entry_words]) {
+          if (ctrl == nullptr || entries == nullptr) [[unlikely]] {
+            capacity = 0;
+            return;
+          }
+          std::uint64_t empty;
+          std::memset(&empty, detail::ctrl_empty, sizeof(empty));
+          for (std::size_t i = 0; i < (slots + group_width) / 8 + 1; i++) {
+            ctrl[i].store(empty, std::memory_order_relaxed);
+          }
+        }
+
+        std::size_t mask() const noexcept { return capacity - 1; }
+
+        // control bytes [pos, pos + group_width), loaded word by word
+        detail::CtrlGroup group(std::size_t pos) const noexcept {
+          std::uint64_t words[group_width / 8 + 1];
+          for (std::size_t i = 0; i < std::size(words); i++) {
+            words[i] = ctrl[pos / 8 + i].load(std::memory_order_relaxed);
+          }
+          return detail::CtrlGroup(reinterpret_cast<const std::uint8_t *>(words) + pos % 8);
+        }
+
+        std::uint8_t get_ctrl(std::size_t i) const noexcept {
+          const std::uint64_t word = ctrl[i / 8].load(std::memory_order_relaxed);
+          std::uint8_t bytes[8];
+          std::memcpy(bytes, &word, 8);
+          return bytes[i % 8];
+        }
+
+        // writers only, under the shard lock
+        void set_ctrl_byte(std::size_t i, std::uint8_t value) noexcept {
+          std::uint64_t word = ctrl[i / 8].load(std::memory_order_relaxed);
+          std::uint8_t bytes[8];
+          std::memcpy(bytes, &word, 8);
+          bytes[i % 8] = value;
+          std::memcpy(&word, bytes, 8);
+          ctrl[i / 8].store(word, std::memory_order_relaxed);
+        }
+
+        void set_ctrl(std::size_t i, std::uint8_t value) noexcept {
+          set_ctrl_byte(i, value);
+          if (i < group_width - 1) {
+            set_ctrl_byte(capacity + i, value);
+          }
+        }
+
+        Entry load(std::size_t i) const noexcept {
+          std::uint64_t words[entry_words];
+          for (std::size_t w = 0; w < entry_words; w++) {
+            words[w] = entries[i * entry_words + w].load(std::memory_order_relaxed);
+          }
+          Entry entry;
+          std::memcpy(static_cast<void *>(&entry), words, sizeof(Entry));
+          return entry;
+        }
+
+        void store(std::size_t i, const Entry &entry) noexcept {
+          std::uint64_t words[entry_words] {};
+          std::memcpy(words, &entry, sizeof(Entry));
+          for (std::size_t w = 0; w < entry_words; w++) {
+            entries[i * entry_words + w].store(words[w], std::memory_order_relaxed);
+          }
+        }
+      };
+
+      struct alignas(64) Shard {
+        std::atomic<std::uint64_t> version = 0; // odd while a writer modifies the table
+        std::atomic<Table *> table = nullptr;
+        std::atomic<std::size_t> size = 0;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Table>> tables; // current one last
+      };
+
+      std::unique_ptr<Shard[]> _shards = std::make_unique<Shard[]>(Shards);
+      [[no_unique_address]] hasher _hash {};
+      [[no_unique_address]] KeyEqual _eq {};
+
+      template <typename Key>
+        std::size_t hash_of(const Key &key) const noexcept { return detail::mix_hash(_hash(key)); }
+
+      // the top bits pick the shard, the low ones h2 and the home slot
+      Shard & shard_of(std::size_t hash) const noexcept {
+        if constexpr (Shards == 1) {
+          return _shards[0];
+        } else {
+          return _shards[hash >> (64 - shard_bits)];
+        }
+      }
+
+      static std::uint8_t h2(std::size_t hash) noexcept { return hash & 0x7F; }
+      static std::size_t home(const Table &table, std::size_t hash) noexcept { return (hash >> 7) & table.mask(); }
+
+      // slot of key in table, npos if absent; the result is only meaningful if the
+      // caller holds the shard lock or validates the seqlock afterwards
+      template <typename Key>
+        std::size_t find_index(const Table &table, const Key &key, std::size_t hash, Entry &entry) const {
+          std::size_t pos = home(table, hash);
+          // bounded: a torn read may show a full table
+          for (std::size_t probed = 0; probed < table.capacity; probed += group_width) {
+            const detail::CtrlGroup group = table.group(pos);
+            for (std::uint32_t match = group.match(h2(hash)); match != 0; match &= match - 1) {
+              const std::size_t i = (pos + std::countr_zero(match)) & table.mask();
+              entry = table.load(i);
+              if (_eq(entry.key, key)) [[likely]] {
+                return i;
+              }
+            }
+            if (group.match_empty() != 0) [[likely]] {
+              break;
+            }
+            pos = (pos + group_width) & table.mask();
+          }
+          return npos;
+        }
+
+      static std::size_t find_empty(const Table &table, std::size_t hash) noexcept {
+        for (std::size_t pos = home(table, hash);; pos = (pos + group_width) & table.mask()) {
+          if (const std::uint32_t empty = table.group(pos).match_empty(); empty != 0) {
+            return (pos + std::countr_zero(empty)) & table.mask();
+          }
+        }
+      }
+
+      // runs fn on the current table of a shard as a seqlock reader, retrying on concurrent writes
+      template <typename Fn>
+        auto read(const Shard &shard, Fn &&fn) const {
+          while (true) {
+            const std::uint64_t version = shard.version.load(std::memory_order_acquire);
+            if ((version & 1) != 0) [[unlikely]] {
+              std::this_thread::yield();
+              continue;
+            }
+            const Table *table = shard.table.load(std::memory_order_acquire);
+            auto result = fn(table);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shard.version.load(std::memory_order_relaxed) == version) [[likely]] {
+              return result;
+            }
+          }
+        }
+
+      // writer side, under the shard lock
+      struct WriteSection {
+        Shard &shard;
+
+        explicit WriteSection(Shard &s) noexcept : shard(s) {
+          shard.version.store(shard.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        ~WriteSection() { shard.version.store(shard.version.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+      };
+
+      // returns the table with room for one more entry, nullptr if it could not grow
+      Table * grow_for(Shard &shard, std::size_t size) {
+        Table *table = shard.table.load(std::memory_order_relaxed);
+        if (table != nullptr && size * 8 <= table->capacity * 7) [[likely]] {
+          return table;
+        }
+
+        auto fresh = std::make_unique<Table>(table == nullptr ? group_width : table->capacity * 2);
+        if (fresh->capacity == 0) [[unlikely]] {
+          // keep going above the load factor while an empty slot is left
+          return table != nullptr && size < table->capacity ? table : nullptr;
+        }
+        if (table != nullptr) {
+          for (std::size_t i = 0; i < table->capacity; i++) {
+            if (table->get_ctrl(i) != detail::ctrl_empty) {
+              const Entry entry = table->load(i);
+              const std::size_t hash = hash_of(entry.key);
+              const std::size_t j = find_empty(*fresh, hash);
+              fresh->store(j, entry);
+              fresh->set_ctrl(j, h2(hash));
+            }
+          }
+        }
+        // readers still probing the old table keep a consistent (if stale) view, and the
+        // version bump of the enclosing write section makes them retry on the new one
+        shard.table.store(fresh.get(), std::memory_order_release);
+        shard.tables.push_back(std::move(fresh));
+        return shard.table.load(std::memory_order_relaxed);
+      }
+
+      static inline constexpr std::size_t npos = ~std::size_t(0);
+
+    public:
+      ConcurrentHashMap() = default;
+
+      ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+      ConcurrentHashMap & operator=(const ConcurrentHashMap &) = delete;
+
+      // inserts or assigns; a new key is dropped if its shard could not grow
+      template <typename Key>
+        requires lookup_key_v<Key> && std::is_constructible_v<K, const Key &>
+        ConcurrentHashMap & emplace(const Key &key, const V &value) {
+          const std::size_t hash = hash_of(key);
+          Shard &shard = shard_of(hash);
+          std::lock_guard lock(shard.mutex);
+          WriteSection section(shard);
+
+          Entry entry;
+          if (Table *table = shard.table.load(std::memory_order_relaxed); table != nullptr) {
+            if (const std::size_t i = find_index(*table, key, hash, entry); i != npos) {
+              entry.value = value;
+              table->store(i, entry);
+              return *this;
+            }
+          }
+
+          const std::size_t size = shard.size.load(std::memory_order_relaxed);
+          Table *table = grow_for(shard, size + 1);
+          if (table == nullptr) [[unlikely]] {
+            return *this;
+          }
+          const std::size_t i = find_empty(*table, hash);
+          table->store(i, Entry {K(key), value});
+          table->set_ctrl(i, h2(hash));
+          shard.size.store(size + 1, std::memory_order_relaxed);
+          return *this;
+        }
+
+      // returns false if there was no such key
+      template <typename Key>
+        requires lookup_key_v<Key>
+        bool erase(const Key &key) {
+          const std::size_t hash = hash_of(key);
+          Shard &shard = shard_of(hash);
+          std::lock_guard lock(shard.mutex);
+          Table *table = shard.table.load(std::memory_order_relaxed);
+          Entry entry;
+          if (table == nullptr) {
+            return false;
+          }
+          std::size_t hole = find_index(*table, key, hash, entry);
+          if (hole == npos) {
+            return false;
+          }
+
+          WriteSection section(shard);
+          // backward shift, as in HashMap::erase_at
+          const std::size_t mask = table->mask();
+          for (std::size_t i = (hole + 1) & mask; table->get_ctrl(i) != detail::ctrl_empty; i = (i + 1) & mask) {
+            entry = table->load(i);
+            const std::size_t from_home = (i - home(*table, hash_of(entry.key))) & mask;
+            if (from_home >= ((i - hole) & mask)) {
+              table->store(hole, entry);
+              table->set_ctrl(hole, table->get_ctrl(i));
+              hole = i;
+            }
+          }
+          table->set_ctrl(hole, detail::ctrl_empty);
+          shard.size.store(shard.size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+          return true;
+        }
+
+      // lock-free: a copy of the value at some point during the call
+      template <typename Key>
+        requires lookup_key_v<Key>
+        std::optional<V> find(const Key &key) const {
+          const std::size_t hash = hash_of(key);
+          return read(shard_of(hash), [&](const Table *table) -> std::optional<V> {
+            Entry entry;
+            if (table == nullptr || find_index(*table, key, hash, entry) == npos) {
+              return std::nullopt;
+            }
+            return entry.value;
+          });
+        }
+
+      template <typename Key>
+        requires lookup_key_v<Key>
+        bool contains(const Key &key) const { return find(key).has_value(); }
+
+      // sum over shards, exact only while no writer is running
+      std::size_t size() const noexcept {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < Shards; i++) {
+          size += _shards[i].size.load(std::memory_order_relaxed);
+        }
+        return size;
+      }
+
+      bool empty() const noexcept { return size() == 0; }
+    };
+}
@@ -1,56 +1,576 @@
 #pragma once
 
+#include <bit>
+#include <iterator>
+
 #include "mr-stl/def.hpp"
+#include "mr-stl/algorithm/search.hpp"
+#include "mr-stl/allocator/heap_allocator.hpp"
+#include "mr-stl/span/span.hpp"
 
 namespace mr {
-  template <typename K, typename V, typename H = std::hash<K>>
-    struct StaticHashmap {
-      inline static constexpr std::size_t length = 1024;
-      inline static constexpr auto hash = [](){
+  namespace detail {
+    // std::hash when it is specialized for K, otherwise the key's own K::Hash
+    template <typename K, typename H>
+      constexpr auto select_hash() {
         if constexpr (std::is_same_v<H, std::hash<K>> &&
             !std::is_invocable_v<H, K>) {
           return typename K::Hash{};
         } else {
           return H{};
         }
-      }();
+      }
+
+    template <typename K, typename H>
+      using hash_t = decltype(select_hash<K, H>());
+
+    // control byte of a slot: empty, or the low 7 bits of the key's hash (h2)
+    inline constexpr std::uint8_t ctrl_empty = 0x80;
+
+#if MR_STL_SIMD
+    inline constexpr std::size_t group_width = simd_width;
+
+    // control bytes of group_width consecutive slots, one mask bit per slot
+    struct CtrlGroup {
+      simd_reg ctrl;
+
+      explicit CtrlGroup(const std::uint8_t *ptr) noexcept : ctrl(simd_load(ptr)) {}
+
+      std::uint32_t match(std::uint8_t h2) const noexcept {
+        return simd_mask(simd_cmpeq<1>(ctrl, simd_broadcast(h2)));
+      }
+
+      // empty is the only control byte with the high bit set
+      std::uint32_t match_empty() const noexcept { return simd_mask(ctrl); }
+    };
+#else
+    inline constexpr std::size_t group_width = 8;
+
+    // SWAR fallback: the group is one 64-bit word
+    // match() may report false positives (above a real match), keys are compared anyway
+    struct CtrlGroup {
+      static inline constexpr std::uint64_t lsbs = 0x0101010101010101;
+      static inline constexpr std::uint64_t msbs = 0x8080808080808080;
+
+      std::uint64_t ctrl;
+
+      explicit CtrlGroup(const std::uint8_t *ptr) noexcept { std::memcpy(&ctrl, ptr, sizeof(ctrl)); }
+
+      // high bit of every byte -> one bit per byte
+      static std::uint32_t compress(std::uint64_t high_bits) noexcept {
+        if constexpr (std::endian::native == std::endian::big) {
+          high_bits = std::byteswap(high_bits);
+        }
+        return static_cast<std::uint32_t>(((high_bits >> 7) * 0x0102040810204080) >> 56);
+      }
+
+      std::uint32_t match(std::uint8_t h2) const noexcept {
+        const std::uint64_t x = ctrl ^ (lsbs * h2);
+        return compress((x - lsbs) & ~x & msbs);
+      }
+
+      std::uint32_t match_empty() const noexcept { return compress(ctrl & msbs); }
+    };
+#endif
+
+    // spreads the entropy of weak hashes (std::hash of integers is the identity)
+    // over all bits, since both the home slot and h2 are taken from it
+    constexpr std::size_t mix_hash(std::size_t hash) noexcept {
+      std::uint64_t x = hash;
+      x ^= x >> 32;
+      x *= 0x9E3779B97F4A7C15;
+      x ^= x >> 29;
+      return static_cast<std::size_t>(x);
+    }
+
+    template <typename H, typename E>
+      inline constexpr bool is_transparent_v =
+        requires { typename H::is_transparent; typename E::is_transparent; };
+  }
+
+  // fixed capacity open addressing map
+  // probing only reads a 1 byte per slot metadata array holding 7 bits of each key's hash
+  // (1 KiB, so it stays in L1); the cached full hash and then the entry itself are only
+  // touched when those bits match
+  template <typename K, typename V, typename H = std::hash<K>>
+    struct StaticHashmap {
+      inline static constexpr std::size_t length = 1024;
+      inline static constexpr auto hash = detail::select_hash<K, H>();
+      using value_type = std::pair<K, V>;
+
       std::size_t _size = 0;
+      // the first group_width - 1 control bytes are cloned at the end for wrapping group loads
+      std::uint8_t _ctrl[length + detail::group_width];
+      std::size_t _hashes[length];
+      alignas(value_type) std::byte _data[length * sizeof(value_type)];
 
-      // array of optional values
-      std::optional<std::pair<K, V>> data[length] {};
+      StaticHashmap() noexcept { std::memset(_ctrl, detail::ctrl_empty, sizeof(_ctrl)); }
 
-      std::optional<StaticHashmap> emplace(const K &key, const V &value) {
-        if (_size == length) {
-          return *this;
+      // copy semantic
+      StaticHashmap(const StaticHashmap &other) : _size(other._size) {
+        std::memcpy(_ctrl, other._ctrl, sizeof(_ctrl));
+        std::memcpy(_hashes, other._hashes, sizeof(_hashes));
+        for (std::size_t i = 0; i < length; i++) {
+          if (_ctrl[i] != detail::ctrl_empty) {
+            std::construct_at(slot(i), *other.slot(i));
+          }
         }
+      }
 
-        std::size_t hash_res = hash(key) & (length - 1);
-        hash_res = handle_collision(hash_res, key);
-        data[hash_res] = {key, value};
-        _size++;
+      StaticHashmap & operator=(const StaticHashmap &other) {
+        if (this != &other) {
+          *this = StaticHashmap(other);
+        }
+        return *this;
+      }
 
+      // move semantic
+      StaticHashmap(StaticHashmap &&other) noexcept : StaticHashmap() {
+        *this = std::move(other);
+      }
+
+      StaticHashmap & operator=(StaticHashmap &&other) noexcept {
+        if (this != &other) {
+          clear();
+          std::memcpy(_ctrl, other._ctrl, sizeof(_ctrl));
+          std::memcpy(_hashes, other._hashes, sizeof(_hashes));
+          for (std::size_t i = 0; i < length; i++) {
+            if (_ctrl[i] != detail::ctrl_empty) {
+              std::construct_at(slot(i), std::move(*other.slot(i)));
+            }
+          }
+          _size = other._size;
+          other.clear();
+        }
+        return *this;
+      }
+
+      ~StaticHashmap() noexcept { clear(); }
+
+      // inserts or assigns; a new key is dropped when the map is full
+      StaticHashmap & emplace(const K &key, const V &value) {
+        const std::size_t key_hash = detail::mix_hash(hash(key));
+        const std::size_t i = handle_collision(key_hash, key);
+        if (i == length) [[unlikely]] {
+          return *this;
+        }
+
+        if (_ctrl[i] == detail::ctrl_empty) {
+          std::construct_at(slot(i), key, value);
+          _hashes[i] = key_hash;
+          set_ctrl(i, key_hash & 0x7F);
+          _size++;
+        } else {
+          slot(i)->second = value;
+        }
         return *this;
       }
 
-      std::optional<V> find(const K &key) {
-        std::size_t hash_res = hash(key) & (length - 1);
-        hash_res = handle_collision(hash_res, key);
-        return data[hash_res].and_then([](auto pair){
-            return std::optional(pair.second);
-            });
+      std::optional<V> find(const K &key) const {
+        const std::size_t i = handle_collision(detail::mix_hash(hash(key)), key);
+        if (i == length || _ctrl[i] == detail::ctrl_empty) {
+          return std::nullopt;
+        }
+        return slot(i)->second;
+      }
+
+      bool contains(const K &key) const {
+        const std::size_t i = handle_collision(detail::mix_hash(hash(key)), key);
+        return i != length && _ctrl[i] != detail::ctrl_empty;
       }
 
-      std::size_t handle_collision(std::size_t ind, K key) {
-        while (data[ind].has_value() &&
-            data[ind]->first != key) [[unlikely]] {
-          ind++;
-          ind %= length;
+      // slot holding key, else the empty slot it would go to, length if the map is full
+      std::size_t handle_collision(std::size_t key_hash, const K &key) const {
+        const auto h2 = static_cast<std::uint8_t>(key_hash & 0x7F);
+        std::size_t pos = (key_hash >> 7) & (length - 1);
+        for (std::size_t probed = 0; probed < length; probed += detail::group_width) {
+          const detail::CtrlGroup group(_ctrl + pos);
+          for (std::uint32_t match = group.match(h2); match != 0; match &= match - 1) {
+            const std::size_t i = (pos + std::countr_zero(match)) & (length - 1);
+            if (_hashes[i] == key_hash && slot(i)->first == key) [[likely]] {
+              return i;
+            }
+          }
+          if (const std::uint32_t empty = group.match_empty(); empty != 0) [[likely]] {
+            return (pos + std::countr_zero(empty)) & (length - 1);
+          }
+          pos = (pos + detail::group_width) & (length - 1);
         }
-        return ind;
+        return length;
+      }
+
+      StaticHashmap & clear() noexcept {
+        for (std::size_t i = 0; i < length && _size != 0; i++) {
+          if (_ctrl[i] != detail::ctrl_empty) {
+            std::destroy_at(slot(i));
+            _size--;
+          }
+        }
+        std::memset(_ctrl, detail::ctrl_empty, sizeof(_ctrl));
+        return *this;
       }
 
+      std::size_t size() const noexcept { return _size; }
+      bool full() const noexcept { return _size == length; }
+
       StaticHashmap & get() {
         return *this;
       }
+
+    private:
+      value_type * slot(std::size_t i) noexcept {
+        return std::launder(reinterpret_cast<value_type *>(_data) + i);
+      }
+      const value_type * slot(std::size_t i) const noexcept {
+        return std::launder(reinterpret_cast<const value_type *>(_data) + i);
+      }
+
+      void set_ctrl(std::size_t i, std::uint8_t ctrl) noexcept {
+        _ctrl[i] = ctrl;
+        if (i < detail::group_width - 1) {
+          _ctrl[length + i] = ctrl;
+        }
+      }
+    };
+
+  // open addressing hash map (SwissTable-style)
+  // - a byte array of control bytes mirrors the slots; lookups compare a whole group of
+  //   them with one SIMD instruction and only touch slots whose 7 hash bits match
+  // - linear probing group by group from the home slot, grows by 2x at 7/8 load
+  // - erase shifts the following displaced entries back, so there are no tombstones
+  //   and lookups never slow down after erasing
+  // - lookups with any key type when Hash and KeyEqual are both transparent
+  // allocation failures leave the map unchanged (try_emplace returns nullptr)
+  template <typename K, typename V,
+            typename Hash = std::hash<K>,
+            typename KeyEqual = std::equal_to<>,
+            typename Allocator = HeapAllocator<std::pair<K, V>>>
+    struct HashMap {
+      using key_type = K;
+      using mapped_type = V;
+      using value_type = std::pair<K, V>;
+      using hasher = detail::hash_t<K, Hash>;
+      using key_equal = KeyEqual;
+      using allocator_type = Allocator;
+
+      // keys of other types are looked up without constructing a K
+      template <typename Key>
+        static inline constexpr bool lookup_key_v =
+          std::is_same_v<std::remove_cvref_t<Key>, K> || detail::is_transparent_v<hasher, KeyEqual>;
+
+    private:
+      using CtrlAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint8_t>;
+
+      static inline constexpr std::size_t group_width = detail::group_width;
+      static inline constexpr std::size_t npos = ~std::size_t(0);
+
+      // capacity is 0 or a power of two >= group_width; the first group_width - 1
+      // control bytes are cloned after the last one, so any group load stays in bounds
+      std::size_t _size = 0;
+      std::size_t _capacity = 0;
+      OwningSpan<std::uint8_t, CtrlAllocator, uninitialized_storage_t> _ctrl;
+      OwningSpan<value_type, Allocator, uninitialized_storage_t> _slots;
+      [[no_unique_address]] hasher _hash {};
+      [[no_unique_address]] KeyEqual _eq {};
+
+      std::size_t mask() const noexcept { return _capacity - 1; }
+
+      template <typename Key>
+        std::size_t hash_of(const Key &key) const noexcept { return detail::mix_hash(_hash(key)); }
+
+      static std::uint8_t h2(std::size_t hash) noexcept { return hash & 0x7F; }
+      std::size_t home(std::size_t hash) const noexcept { return (hash >> 7) & mask(); }
+
+      void set_ctrl(std::size_t i, std::uint8_t ctrl) noexcept {
+        _ctrl[i] = ctrl;
+        if (i < group_width - 1) {
+          _ctrl[_capacity + i] = ctrl;
+        }
+      }
+
+      template <typename Key>
+        std::size_t find_index(const Key &key) const {
+          if (_capacity == 0) [[unlikely]] {
+            return npos;
+          }
+          const std::size_t hash = hash_of(key);
+          for (std::size_t pos = home(hash);; pos = (pos + group_width) & mask()) {
+            const detail::CtrlGroup group(_ctrl.data() + pos);
+            for (std::uint32_t match = group.match(h2(hash)); match != 0; match &= match - 1) {
+              const std::size_t i = (pos + std::countr_zero(match)) & mask();
+              if (_eq(_slots[i].first, key)) [[likely]] {
+                return i;
+              }
+            }
+            // entries are never stored past an empty slot of their probe sequence
+            if (group.match_empty() != 0) [[likely]] {
+              return npos;
+            }
+          }
+        }
+
+      // first empty slot of the probe sequence, there always is one
+      std::size_t find_empty(std::size_t hash) const noexcept {
+        for (std::size_t pos = home(hash);; pos = (pos + group_width) & mask()) {
+          if (const std::uint32_t empty = detail::CtrlGroup(_ctrl.data() + pos).match_empty(); empty != 0) {
+            return (pos + std::countr_zero(empty)) & mask();
+          }
+        }
+      }
+
+      // rehashes into capacity slots, returns false and keeps the map on allocation failure
+      bool rehash(std::size_t capacity) {
+        if (capacity > PTRDIFF_MAX / sizeof(value_type)) [[unlikely]] {
+          return false;
+        }
+        decltype(_ctrl) ctrl(capacity + group_width, _ctrl.get_allocator());
+        decltype(_slots) slots(capacity, _slots.get_allocator());
+        if (ctrl.data() == nullptr || slots.data() == nullptr) [[unlikely]] {
+          return false;
+        }
+        std::memset(ctrl.data(), detail::ctrl_empty, capacity + group_width);
+
+        std::swap(_ctrl, ctrl);
+        std::swap(_slots, slots);
+        const std::size_t old_capacity = std::exchange(_capacity, capacity);
+        for (std::size_t i = 0; i < old_capacity; i++) {
+          if (ctrl[i] != detail::ctrl_empty) {
+            const std::size_t hash = hash_of(slots[i].first);
+            const std::size_t j = find_empty(hash);
+            set_ctrl(j, h2(hash));
+            std::construct_at(_slots.data() + j, std::move(slots[i]));
+            std::destroy_at(slots.data() + i);
+          }
+        }
+        return true;
+      }
+
+      // max load 7/8
+      bool grow_for(std::size_t size) {
+        if (size * 8 <= _capacity * 7) [[likely]] {
+          return true;
+        }
+        if (rehash(std::max(_capacity * 2, group_width))) [[likely]] {
+          return true;
+        }
+        // keep going above the load factor while an empty slot is left
+        return size < _capacity;
+      }
+
+      // removes slot i and moves later entries of its cluster back into the hole
+      // when that keeps them reachable from their home slot
+      void erase_at(std::size_t hole) {
+        std::destroy_at(_slots.data() + hole);
+        for (std::size_t i = (hole + 1) & mask(); _ctrl[i] != detail::ctrl_empty; i = (i + 1) & mask()) {
+          const std::size_t from_home = (i - home(hash_of(_slots[i].first))) & mask();
+          if (from_home >= ((i - hole) & mask())) {
+            std::construct_at(_slots.data() + hole, std::move(_slots[i]));
+            std::destroy_at(_slots.data() + i);
+            set_ctrl(hole, _ctrl[i]);
+            hole = i;
+          }
+        }
+        set_ctrl(hole, detail::ctrl_empty);
+        _size--;
+      }
+
+      void destroy_slots() noexcept {
+        if (_size == 0) {
+          return;
+        }
+        for (std::size_t i = 0; i < _capacity; i++) {
+          if (_ctrl[i] != detail::ctrl_empty) {
+            std::destroy_at(_slots.data() + i);
+          }
+        }
+      }
+
+      template <bool Const>
+        struct Iterator {
+          using Map = std::conditional_t<Const, const HashMap, HashMap>;
+          using value_type = std::pair<K, V>;
+          using difference_type = std::ptrdiff_t;
+          using reference = std::conditional_t<Const, const value_type &, value_type &>;
+          using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+
+          Map *map = nullptr;
+          std::size_t index = 0;
+
+          reference operator*() const noexcept { return map->_slots[index]; }
+          pointer operator->() const noexcept { return &map->_slots[index]; }
+
+          Iterator & operator++() noexcept {
+            while (++index < map->_capacity && map->_ctrl[index] == detail::ctrl_empty) {}
+            return *this;
+          }
+
+          Iterator operator++(int) noexcept {
+            Iterator tmp = *this;
+            ++*this;
+            return tmp;
+          }
+
+          bool operator==(const Iterator &) const noexcept = default;
+        };
+
+      template <bool Const>
+        Iterator<Const> first(auto *self) const noexcept {
+          Iterator<Const> it {self, 0};
+          if (_capacity != 0 && _ctrl[0] == detail::ctrl_empty) {
+            ++it;
+          }
+          return it;
+        }
+
+    public:
+      using iterator = Iterator<false>;
+      using const_iterator = Iterator<true>;
+
+      HashMap() noexcept = default;
+
+      explicit HashMap(const Allocator &alloc) noexcept : _ctrl(CtrlAllocator(alloc)), _slots(alloc) {}
+
+      HashMap(const HashMap &other) : _ctrl(other._ctrl.get_allocator()), _slots(other._slots.get_allocator()),
+                                      _hash(other._hash), _eq(other._eq) {
+        if (other._capacity == 0) {
+          return;
+        }
+        decltype(_ctrl) ctrl(other._capacity + group_width, _ctrl.get_allocator());
+        decltype(_slots) slots(other._capacity, _slots.get_allocator());
+        if (ctrl.data() == nullptr || slots.data() == nullptr) [[unlikely]] {
+          return;
+        }
+        // same layout, so entries are copied slot by slot without rehashing
+        std::memcpy(ctrl.data(), other._ctrl.data(), other._capacity + group_width);
+        for (std::size_t i = 0; i < other._capacity; i++) {
+          if (other._ctrl[i] != detail::ctrl_empty) {
+            std::construct_at(slots.data() + i, other._slots[i]);
+          }
+        }
+        _ctrl = std::move(ctrl);
+        _slots = std::move(slots);
+        _capacity = other._capacity;
+        _size = other._size;
+      }
+
+      HashMap & operator=(const HashMap &other) {
+        if (this != &other) {
+          *this = HashMap(other);
+        }
+        return *this;
+      }
+
+      HashMap(HashMap &&other) noexcept :
+        _size(std::exchange(other._size, 0)), _capacity(std::exchange(other._capacity, 0)),
+        _ctrl(std::move(other._ctrl)), _slots(std::move(other._slots)), _hash(other._hash), _eq(other._eq) {}
+
+      HashMap & operator=(HashMap &&other) noexcept {
+        if (this != &other) {
+          destroy_slots();
+          _ctrl = std::move(other._ctrl);
+          _slots = std::move(other._slots);
+          _size = std::exchange(other._size, 0);
+          _capacity = std::exchange(other._capacity, 0);
+          _hash = other._hash;
+          _eq = other._eq;
+        }
+        return *this;
+      }
+
+      ~HashMap() noexcept { destroy_slots(); }
+
+      // value of key, constructed from args if the key is new
+      // returns nullptr if the key is new and the map could not grow
+      template <typename Key, typename ...Args>
+        requires lookup_key_v<Key> && std::is_constructible_v<K, Key &&>
+        V * try_emplace(Key &&key, Args &&...args) {
+          if (const std::size_t i = find_index(key); i != npos) {
+            return &_slots[i].second;
+          }
+          if (!grow_for(_size + 1)) [[unlikely]] {
+            return nullptr;
+          }
+          const std::size_t hash = hash_of(key);
+          const std::size_t i = find_empty(hash);
+          std::construct_at(_slots.data() + i, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+          set_ctrl(i, h2(hash));
+          _size++;
+          return &_slots[i].second;
+        }
+
+      // inserts or assigns
+      template <typename Key, typename Value>
+        requires lookup_key_v<Key> && std::is_constructible_v<K, Key &&> && std::is_assignable_v<V &, Value &&>
+        HashMap & emplace(Key &&key, Value &&value) {
+          if (V *slot = find(key); slot != nullptr) {
+            *slot = std::forward<Value>(value);
+          } else {
+            try_emplace(std::forward<Key>(key), std::forward<Value>(value));
+          }
+          return *this;
+        }
+
+      template <typename Key>
+        requires lookup_key_v<Key>
+        V * find(const Key &key) {
+          const std::size_t i = find_index(key);
+          return i == npos ? nullptr : &_slots[i].second;
+        }
+
+      template <typename Key>
+        requires lookup_key_v<Key>
+        const V * find(const Key &key) const {
+          const std::size_t i = find_index(key);
+          return i == npos ? nullptr : &_slots[i].second;
+        }
+
+      template <typename Key>
+        requires lookup_key_v<Key>
+        bool contains(const Key &key) const { return find_index(key) != npos; }
+
+      // returns false if there was no such key
+      template <typename Key>
+        requires lookup_key_v<Key>
+        bool erase(const Key &key) {
+          const std::size_t i = find_index(key);
+          if (i == npos) {
+            return false;
+          }
+          erase_at(i);
+          return true;
+        }
+
+      // makes room for size entries without rehashing
+      HashMap & reserve(std::size_t size) {
+        std::size_t capacity = std::max(_capacity, group_width);
+        while (size * 8 > capacity * 7) {
+          capacity *= 2;
+        }
+        if (capacity != _capacity) {
+          rehash(capacity);
+        }
+        return *this;
+      }
+
+      // capacity is kept
+      HashMap & clear() noexcept {
+        destroy_slots();
+        if (_capacity != 0) {
+          std::memset(_ctrl.data(), detail::ctrl_empty, _capacity + group_width);
+        }
+        _size = 0;
+        return *this;
+      }
+
+      std::size_t size() const noexcept { return _size; }
+      bool empty() const noexcept { return _size == 0; }
+      std::size_t capacity() const noexcept { return _capacity; }
+      float load_factor() const noexcept { return _capacity == 0 ? 0 : static_cast<float>(_size) / _capacity; }
+
+      iterator begin() noexcept { return first<false>(this); }
+      iterator end() noexcept { return {this, _capacity}; }
+      const_iterator begin() const noexcept { return first<true>(this); }
+      const_iterator end() const noexcept { return {this, _capacity}; }
     };
 }
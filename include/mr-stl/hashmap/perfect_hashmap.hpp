@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <string_view>
+
+#include "mr-stl/def.hpp"
+#include "mr-stl/string/hash.hpp"
+
+namespace mr {
+  namespace detail {
+    // constexpr seeded hash: strings (anything convertible to std::string_view) go through
+    // hash_bytes, so string_view, C string and String lookups agree; integers and enums are
+    // mixed with one multiply
+    template <typename T>
+      constexpr std::uint64_t seeded_hash(const T &key, std::uint64_t seed) noexcept {
+        if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+          const std::string_view str = key;
+          return hash_bytes(str.data(), str.size(), seed);
+        } else {
+          static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "no constexpr hash for this key type");
+          return mix(static_cast<std::uint64_t>(key) ^ hash_secret[0], seed ^ hash_secret[1]);
+        }
+      }
+
+    // compile time diagnostics: reaching one of these in a constant expression fails the build
+    inline void perfect_hash_duplicate_keys() noexcept {}
+    inline void perfect_hash_no_seed_found() noexcept {}
+  }
+
+  // immutable map over a key set known at compile time, with a perfect hash (PTHash-style):
+  // keys hash into ~N/4 buckets, and every bucket got a pilot value that sends its keys
+  // to free slots, so a lookup is one hash, one slot load and one key compare, no probing
+  //   constexpr mr::PerfectHashMap opcodes(std::array {
+  //     std::pair {std::string_view("add"), 0x01}, std::pair {std::string_view("sub"), 0x02}});
+  //   static_assert(*opcodes.find("sub") == 0x02);
+  // construction is constexpr, duplicate keys are a compile error in constant evaluation
+  template <typename K, typename V, std::size_t N>
+    struct PerfectHashMap {
+      using key_type = K;
+      using mapped_type = V;
+      using value_type = std::pair<K, V>;
+
+      // load factor 0.4..0.8 keeps the pilot search short
+      static inline constexpr std::size_t slot_count = std::bit_ceil(N * 5 / 4 + 1);
+      static inline constexpr std::size_t bucket_count = std::bit_ceil(N / 4 + 1);
+
+    private:
+      using Index = std::conditional_t<(N < 0xFF), std::uint8_t,
+                    std::conditional_t<(N < 0xFFFF), std::uint16_t, std::uint32_t>>;
+
+      static inline constexpr Index empty_slot = static_cast<Index>(N);
+      static inline constexpr std::uint64_t max_pilot = 1 << 16;
+      static inline constexpr int max_seeds = 64;
+
+      std::array<value_type, N> _entries;
+      std::array<Index, slot_count> _slots {};          // entry index, empty_slot if none
+      std::array<std::uint64_t, bucket_count> _pilots {}; // hashed pilot of each bucket
+      std::uint64_t _seed = 0;
+      bool _valid = false;
+
+      static constexpr std::size_t bucket_of(std::uint64_t hash) noexcept {
+        if constexpr (bucket_count == 1) {
+          return 0;
+        } else {
+          return hash >> (64 - std::countr_zero(bucket_count));
+        }
+      }
+
+      // multiplicative hashing: the top bits of the product depend on every bit of hash ^ pilot,
+      // so keys of one bucket that share their low bits still get split by some pilot
+      static constexpr std::size_t slot_of(std::uint64_t hash, std::uint64_t pilot) noexcept {
+        if constexpr (slot_count == 1) {
+          return 0;
+        } else {
+          return ((hash ^ pilot) * 0x9E3779B97F4A7C15) >> (64 - std::countr_zero(slot_count));
+        }
+      }
+
+      static constexpr std::uint64_t hash_pilot(std::uint64_t pilot) noexcept {
+        return detail::mix(pilot ^ detail::hash_secret[2], detail::hash_secret[3]);
+      }
+
+      // places every bucket with the given seed, false if some bucket found no pilot
+      constexpr bool build(std::uint64_t seed) {
+        std::array<std::uint64_t, N> hashes {};
+        std::array<std::size_t, N> by_bucket {};
+        for (std::size_t i = 0; i < N; i++) {
+          hashes[i] = detail::seeded_hash(_entries[i].first, seed);
+          by_bucket[i] = i;
+        }
+
+        // equal full hashes can never be separated: duplicate keys, or a new seed is needed
+        std::sort(by_bucket.begin(), by_bucket.end(), [&](std::size_t a, std::size_t b) { return hashes[a] < hashes[b]; });
+        for (std::size_t i = 1; i < N; i++) {
+          if (hashes[by_bucket[i - 1]] == hashes[by_bucket[i]]) {
+            if (_entries[by_bucket[i - 1]].first == _entries[by_bucket[i]].first) {
+              detail::perfect_hash_duplicate_keys();
+            }
+            return false;
+          }
+        }
+
+        // largest buckets first, while most slots are still free
+        std::array<std::size_t, bucket_count> sizes {};
+        for (std::size_t i = 0; i < N; i++) {
+          sizes[bucket_of(hashes[i])]++;
+        }
+        std::sort(by_bucket.begin(), by_bucket.end(), [&](std::size_t a, std::size_t b) {
+          const std::size_t bucket_a = bucket_of(hashes[a]), bucket_b = bucket_of(hashes[b]);
+          return sizes[bucket_a] != sizes[bucket_b] ? sizes[bucket_a] > sizes[bucket_b] : bucket_a < bucket_b;
+        });
+
+        _slots.fill(empty_slot);
+        _pilots.fill(0);
+        for (std::size_t begin = 0; begin < N;) {
+          const std::size_t bucket = bucket_of(hashes[by_bucket[begin]]);
+          const std::size_t end = begin + sizes[bucket];
+
+          bool placed = false;
+          for (std::uint64_t pilot = 0; pilot < max_pilot && !placed; pilot++) {
+            const std::uint64_t hashed = hash_pilot(pilot);
+            std::size_t i = begin;
+            for (; i < end && _slots[slot_of(hashes[by_bucket[i]], hashed)] == empty_slot; i++) {
+              _slots[slot_of(hashes[by_bucket[i]], hashed)] = static_cast<Index>(by_bucket[i]);
+            }
+            placed = i == end;
+            if (placed) {
+              _pilots[bucket] = hashed;
+            } else {
+              // undo the keys of this bucket placed so far
+              while (i-- > begin) {
+                _slots[slot_of(hashes[by_bucket[i]], hashed)] = empty_slot;
+              }
+            }
+          }
+          if (!placed) {
+            return false;
+          }
+          begin = end;
+        }
+        _seed = seed;
+        return true;
+      }
+
+    public:
+      constexpr explicit PerfectHashMap(const std::array<value_type, N> &entries) : _entries(entries) {
+        for (int seed = 0; seed < max_seeds; seed++) {
+          if (build(detail::mix(seed, detail::hash_secret[0]))) {
+            _valid = true;
+            return;
+          }
+        }
+        // duplicate keys, or no seed let every bucket find a pilot: a compile error in
+        // constant evaluation; at run time the map is left empty and valid() is false
+        _slots.fill(empty_slot);
+        detail::perfect_hash_no_seed_found();
+      }
+
+      // false if construction failed, then every lookup misses
+      constexpr bool valid() const noexcept { return _valid; }
+
+      // keys of other types work if they compare equal to K and hash the same way
+      // (e.g. C strings and String for std::string_view keys)
+      template <typename Key>
+        constexpr const V * find(const Key &key) const noexcept {
+          const std::uint64_t hash = detail::seeded_hash(key, _seed);
+          const Index index = _slots[slot_of(hash, _pilots[bucket_of(hash)])];
+          if (index == empty_slot || !(_entries[index].first == key)) {
+            return nullptr;
+          }
+          return &_entries[index].second;
+        }
+
+      template <typename Key>
+        constexpr bool contains(const Key &key) const noexcept { return find(key) != nullptr; }
+
+      static constexpr std::size_t size() noexcept { return N; }
+
+      // entries in the order they were given
+      constexpr const value_type * begin() const noexcept { return _entries.data(); }
+      constexpr const value_type * end() const noexcept { return _entries.data() + N; }
+    };
+
+  template <typename K, typename V, std::size_t N>
+    PerfectHashMap(const std::array<std::pair<K, V>, N> &) -> PerfectHashMap<K, V, N>;
+}
@@ -2,15 +2,29 @@
 #define __mr_stl_hpp__
 
 #include "def.hpp"
+#include "allocator/heap_allocator.hpp"
+#include "allocator/arena_allocator.hpp"
+#include "allocator/pool_allocator.hpp"
 #if __cpp_lib_span >= 202002L
 #  include "span/span.hpp"
 #endif
 #include "vector/vector.hpp"
-// #include "vector/amortized_vector.hpp"
+#include "vector/amortized_vector.hpp"
+#include "vector/segmented_vector.hpp"
+#include "vector/concurrent_vector.hpp"
+#include "string/hash.hpp"
 #include "string/string.hpp"
 #include "hashmap/hashmap.hpp"
+#include "hashmap/concurrent_hashmap.hpp"
+#include "hashmap/perfect_hashmap.hpp"
 #include "graph/graph.hpp"
+#include "graph/parallel.hpp"
+#include "thread/thread_pool.hpp"
 #include "algorithm/algorithm.hpp"
+#include "algorithm/search.hpp"
+#include "algorithm/sorting_network.hpp"
+#include "algorithm/stable_sort.hpp"
+#include "algorithm/select.hpp"
 #include "ringbuf/dynamic_ringbuf.hpp"
 #include "ringbuf/static_ringbuf.hpp"
 
@@ -100,7 +100,9 @@ namespace mr {
 
       void resize(std::size_t new_capacity) {
         mr::Vector<T> new_buffer;
-        new_buffer.resize(new_capacity);
+        // every slot of the capacity is addressed by the ring, so all of them must be alive
+        new_buffer.reserve(new_capacity);
+        new_buffer.resize(new_buffer.capacity());
         for (std::size_t i = 0; i < _size; ++i) {
           new_buffer[i] = (*this)[i];
         }
@@ -1,67 +1,77 @@
 #pragma once
 
+#include <array>
+
 #include "mr-stl/def.hpp"
+#include "mr-stl/algorithm/search.hpp"
+#include "mr-stl/allocator/heap_allocator.hpp"
 
 namespace mr {
   template <typename T>
     using Span = std::span<T>;
 
-  template <typename T>
-    struct OwningSpan : FlatRangeMethods<OwningSpan, T>,
-                        RangeOutputOperators<OwningSpan, T> {
+  template <typename T,
+            typename Allocator = HeapAllocator<T>,
+            typename Storage = initialized_storage_t>
+    struct OwningSpan : FlatRangeMethods<OwningSpan, T, Allocator, Storage>,
+                        RangeOutputOperators<OwningSpan, T, Allocator, Storage> {
+      using allocator_type = Allocator;
+
+      // raw spans never construct or destroy elements
+      static inline constexpr bool raw = std::is_same_v<Storage, uninitialized_storage_t>;
+
       std::size_t _capacity = 0;
       T* _data = nullptr;
+      [[no_unique_address]] Allocator _alloc = {};
 
       OwningSpan() noexcept = default;
 
-      OwningSpan(const OwningSpan &other) noexcept {
+      explicit OwningSpan(const Allocator &alloc) noexcept : _alloc(alloc) {}
+
+      // raw spans do not know which slots are alive, so only their owner can copy them
+      OwningSpan(const OwningSpan &other) noexcept requires (!raw) : _alloc(other._alloc) {
         if (this == &other) {
           return;
         }
 
-        if (_capacity < other._capacity) {
-          delete[] _data;
-          _data = new (std::nothrow) T[other._capacity];
+        if (_data = _alloc.allocate(other._capacity); _data != nullptr) {
+          std::uninitialized_copy_n(other._data, other._capacity, _data);
           _capacity = other._capacity;
         }
-
-        if (_data != nullptr) {
-          std::memcpy(_data, other._data, _capacity * sizeof(T));
-        }
       }
 
-      OwningSpan & operator=(const OwningSpan &other) noexcept {
+      OwningSpan & operator=(const OwningSpan &other) noexcept requires (!raw) {
         if (this == &other) { return *this; }
 
-        if (_capacity < other._capacity) {
-          delete[] _data;
-          _data = new (std::nothrow) T[other._capacity];
-          _capacity = other._capacity;
+        if (_capacity != other._capacity) {
+          release();
+          if (_data = _alloc.allocate(other._capacity); _data != nullptr) {
+            std::uninitialized_default_construct_n(_data, other._capacity);
+            _capacity = other._capacity;
+          }
         }
 
-        if (_data != nullptr) {
-          std::memcpy(_data, other._data, _capacity * sizeof(T));
-        }
+        std::copy_n(other._data, _capacity, _data);
 
         return *this;
       }
 
-      OwningSpan(OwningSpan &&other) noexcept {
+      OwningSpan(OwningSpan &&other) noexcept : _alloc(other._alloc) {
         if (this == &other) { return; }
 
-        delete[] _data;
-
         _data = std::move(other._data);
         _capacity = std::move(other._capacity);
         other._data = nullptr;
         other._capacity = 0;
       }
 
+      // allocator is propagated together with the buffer it owns
       OwningSpan & operator=(OwningSpan &&other) noexcept {
         if (this == &other) { return *this; }
 
-        delete[] _data;
+        release();
 
+        _alloc = other._alloc;
         _data = std::move(other._data);
         _capacity = std::move(other._capacity);
         other._data = nullptr;
@@ -69,50 +79,102 @@ namespace mr {
         return *this;
       }
 
-      ~OwningSpan() noexcept { delete[] _data; }
+      ~OwningSpan() noexcept { release(); }
 
-      OwningSpan(const T *data, std::size_t size) noexcept :
-        _data(new (std::nothrow) T[size]), _capacity(size) {
-          std::memcpy(_data, data, _capacity * sizeof(T));
-        }
-      OwningSpan(T *data, std::size_t size) noexcept :
-        _data(new (std::nothrow) T[size]), _capacity(size) {
-          std::memcpy(_data, data, _capacity * sizeof(T));
+      OwningSpan(const T *data, std::size_t size, const Allocator &alloc = {}) noexcept requires (!raw) :
+        _alloc(alloc) {
+          if (_data = _alloc.allocate(size); _data != nullptr) {
+            std::uninitialized_copy_n(data, size, _data);
+            _capacity = size;
+          }
         }
+      OwningSpan(T *data, std::size_t size, const Allocator &alloc = {}) noexcept requires (!raw) :
+        OwningSpan(static_cast<const T *>(data), size, alloc) {}
 
       template <typename ...Args>
-        requires (std::is_convertible_v<T, Args> && ...)
-        OwningSpan(Args... args) :
-          _data(new (std::nothrow) T[sizeof...(args)]),
-          _capacity(sizeof...(args)) {
+        requires (!raw && (std::is_convertible_v<T, Args> && ...))
+        OwningSpan(Args... args) {
+          if (_data = _alloc.allocate(sizeof...(args)); _data != nullptr) {
             std::array<T, sizeof...(args)> tmp {args...};
-            std::memcpy(_data, tmp.data(), tmp.size() * sizeof(T));
+            std::uninitialized_move_n(tmp.data(), tmp.size(), _data);
+            _capacity = sizeof...(args);
           }
+        }
 
-      OwningSpan(std::size_t size) noexcept {
+      OwningSpan(std::size_t size, const Allocator &alloc = {}) noexcept :
+        _alloc(alloc) {
         if (size == 0) [[unlikely]] {
           return;
         }
 
-        if (_data = new (std::nothrow) T[size];
+        if (_data = _alloc.allocate(size);
             _data != nullptr) {
+          if constexpr (!raw) {
+            std::uninitialized_default_construct_n(_data, size);
+          }
           _capacity = size;
         }
       }
 
+      // change capacity keeping the contents, in place if the allocator can
+      // returns false and leaves the span untouched on failure
+      bool reallocate(std::size_t size) noexcept requires is_trivially_relocatable_v<T> {
+        if (!raw && size < _capacity) {
+          std::destroy_n(_data + size, _capacity - size);
+        }
+
+        T *tmp = nullptr;
+        if constexpr (requires { _alloc.reallocate(_data, _capacity, size); }) {
+          tmp = _alloc.reallocate(_data, _capacity, size);
+        } else if (tmp = _alloc.allocate(size); tmp != nullptr) [[likely]] {
+          if (_data != nullptr) {
+            std::memcpy(static_cast<void *>(tmp), _data, std::min(size, _capacity) * sizeof(T));
+            _alloc.deallocate(_data, _capacity);
+          }
+        }
+
+        if (tmp == nullptr) [[unlikely]] {
+          if (!raw && size < _capacity) {
+            std::uninitialized_default_construct_n(_data + size, _capacity - size);
+          }
+          return false;
+        }
+
+        if (!raw && size > _capacity) {
+          std::uninitialized_default_construct_n(tmp + _capacity, size - _capacity);
+        }
+        _data = tmp;
+        _capacity = size;
+        return true;
+      }
+
       T * data() noexcept { return _data; }
       const T * data() const noexcept { return _data; }
 
       std::size_t size() const noexcept { return _capacity; }
 
+      Allocator get_allocator() const noexcept { return _alloc; }
+
       T & operator[](std::size_t i) { return _data[i]; }
       const T & operator[](std::size_t i) const { return _data[i]; }
 
-      bool operator<(const OwningSpan<T> &other) const noexcept {
+      bool operator<(const OwningSpan &other) const noexcept {
         if (_capacity != other._capacity) {
           return _capacity < other._capacity;
         }
-        return std::memcmp(_data, other._data, _capacity * sizeof(T));
+        return mr::lexicographical_compare(*this, other);
+      }
+
+    private:
+      void release() noexcept {
+        if (_data != nullptr) {
+          if constexpr (!raw) {
+            std::destroy_n(_data, _capacity);
+          }
+          _alloc.deallocate(_data, _capacity);
+        }
+        _data = nullptr;
+        _capacity = 0;
       }
     };
 }
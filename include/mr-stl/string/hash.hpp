@@ -0,0 +1,108 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mr {
+  namespace detail {
+    // wyhash's default secret: odd constants with 32 set bits each
+    inline constexpr std::uint64_t hash_secret[4] {
+      0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47
+    };
+
+    // 64 x 64 -> 128 bit multiply, low half into a and high half into b
+    constexpr void mum(std::uint64_t &a, std::uint64_t &b) noexcept {
+#if defined(__SIZEOF_INT128__)
+      __extension__ using uint128 = unsigned __int128;
+      const uint128 r = static_cast<uint128>(a) * b;
+      a = static_cast<std::uint64_t>(r);
+      b = static_cast<std::uint64_t>(r >> 64);
+#else
+      const std::uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<std::uint32_t>(a), lb = static_cast<std::uint32_t>(b);
+      const std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+      const std::uint64_t t = rl + (rm0 << 32);
+      const std::uint64_t lo = t + (rm1 << 32);
+      const std::uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+      a = lo;
+      b = hi;
+#endif
+    }
+
+    constexpr std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept {
+      mum(a, b);
+      return a ^ b;
+    }
+
+    // little endian loads, so hashes are the same on every platform and in constant evaluation
+    template <std::size_t N>
+      constexpr std::uint64_t read_le(const char *ptr) noexcept {
+        if (std::is_constant_evaluated()) {
+          std::uint64_t value = 0;
+          for (std::size_t i = 0; i < N; i++) {
+            value |= static_cast<std::uint64_t>(static_cast<unsigned char>(ptr[i])) << (8 * i);
+          }
+          return value;
+        } else {
+          std::conditional_t<N == 8, std::uint64_t, std::uint32_t> value;
+          std::memcpy(&value, ptr, N);
+          if constexpr (std::endian::native == std::endian::big) {
+            value = std::byteswap(value);
+          }
+          return value;
+        }
+      }
+  }
+
+  // 64-bit hash of a byte string (wyhash): three independent multiply lanes over
+  // 48 byte blocks, branch-light handling of short keys; different seeds give
+  // independent hash functions (for tables exposed to untrusted keys)
+  constexpr std::uint64_t hash_bytes(const char *data, std::size_t size, std::uint64_t seed = 0) noexcept {
+    using namespace detail;
+    const char *ptr = data;
+    seed ^= mix(seed ^ hash_secret[0], hash_secret[1]);
+
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    if (size <= 16) [[likely]] {
+      if (size >= 4) {
+        // two overlapping 4 byte reads from each end cover 4..16 bytes
+        const std::size_t shift = (size >> 3) << 2;
+        a = (read_le<4>(ptr) << 32) | read_le<4>(ptr + shift);
+        b = (read_le<4>(ptr + size - 4) << 32) | read_le<4>(ptr + size - 4 - shift);
+      } else if (size > 0) {
+        a = (static_cast<std::uint64_t>(static_cast<unsigned char>(ptr[0])) << 16) |
+            (static_cast<std::uint64_t>(static_cast<unsigned char>(ptr[size >> 1])) << 8) |
+            static_cast<unsigned char>(ptr[size - 1]);
+      }
+    } else {
+      std::size_t left = size;
+      if (left > 48) {
+        std::uint64_t lane1 = seed;
+        std::uint64_t lane2 = seed;
+        do {
+          seed = mix(read_le<8>(ptr) ^ hash_secret[1], read_le<8>(ptr + 8) ^ seed);
+          lane1 = mix(read_le<8>(ptr + 16) ^ hash_secret[2], read_le<8>(ptr + 24) ^ lane1);
+          lane2 = mix(read_le<8>(ptr + 32) ^ hash_secret[3], read_le<8>(ptr + 40) ^ lane2);
+          ptr += 48;
+          left -= 48;
+        } while (left > 48);
+        seed ^= lane1 ^ lane2;
+      }
+      while (left > 16) {
+        seed = mix(read_le<8>(ptr) ^ hash_secret[1], read_le<8>(ptr + 8) ^ seed);
+        ptr += 16;
+        left -= 16;
+      }
+      // last 16 bytes, overlapping the previous block if needed
+      a = read_le<8>(ptr + left - 16);
+      b = read_le<8>(ptr + left - 8);
+    }
+
+    a ^= hash_secret[1];
+    b ^= seed;
+    mum(a, b);
+    return mix(a ^ hash_secret[0] ^ size, b ^ hash_secret[1]);
+  }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string_view>
+#include "mr-stl/string/hash.hpp"
 #include "mr-stl/vector/vector.hpp"
 
 namespace mr {
@@ -14,24 +15,42 @@ namespace mr {
       String(const C *str) : Vector<C>(str, strlen(str)) {}
       String(C *str) : Vector<C>((const C *)str, strlen(str)) {}
 
+      // copy semantic
+      String(const String &other) = default;
+      String & operator=(const String &other) = default;
+
       // move semantic
       String(String &&other) noexcept = default;
       String & operator=(String &&other) noexcept = default;
 
       ~String() noexcept = default;
 
+      // transparent: String, StringView and C strings with equal contents hash the same
+      // a non-zero seed selects an independent hash function
       struct Hash {
-        std::size_t operator()(const String &s){
-          // pick 5 characters and sum them up
-          char range[5] {};
-          for (int i = 0; i < 5; i++) {
-            if (i > s.size()) {
-            }
-          }
-          return 0;
+        using is_transparent = void;
+
+        std::uint64_t seed = 0;
+
+        std::size_t operator()(std::basic_string_view<C> str) const noexcept {
+          return mr::hash_bytes(reinterpret_cast<const char *>(str.data()), str.size() * sizeof(C), seed);
         }
       };
 
+      operator std::basic_string_view<C>() const noexcept { return {this->data(), this->size()}; }
+
+      friend bool operator==(const String &lhs, const String &rhs) noexcept {
+        return std::basic_string_view<C>(lhs) == std::basic_string_view<C>(rhs);
+      }
+
+      friend bool operator==(const String &lhs, std::basic_string_view<C> rhs) noexcept {
+        return std::basic_string_view<C>(lhs) == rhs;
+      }
+
+      friend bool operator==(const String &lhs, const C *rhs) noexcept {
+        return std::basic_string_view<C>(lhs) == rhs;
+      }
+
       String operator+(const String &other) const noexcept {
         String tmp {Vector<C>::_size + other._size};
 
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mr-stl/def.hpp"
+
+namespace mr {
+  struct ThreadPool;
+
+  namespace detail {
+    // queue owned by the calling thread when it is a pool worker
+    struct WorkerInfo {
+      const ThreadPool *pool = nullptr;
+      std::size_t index = 0;
+    };
+  }
+
+  // fixed set of worker threads with a task deque each (work stealing)
+  // - a thread pushes and pops its own deque at the back, so forked work stays cache hot
+  // - idle threads steal from the front of other deques, where the oldest (largest) tasks are
+  // - threads outside the pool share one extra deque
+  // threads waiting on a TaskGroup run queued tasks too, so ThreadPool(n) keeps
+  // n + 1 threads busy while its owner waits
+  struct ThreadPool {
+    using Task = std::function<void()>;
+
+  private:
+    struct alignas(64) Queue {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    static inline thread_local detail::WorkerInfo _current {};
+
+    std::unique_ptr<Queue[]> _queues;   // one per worker plus the shared one
+    std::vector<std::thread> _workers;
+    std::atomic<std::size_t> _queued = 0;
+    std::atomic<bool> _stop = false;
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+
+    std::size_t queue_count() const noexcept { return _workers.size() + 1; }
+
+    std::size_t own_queue() const noexcept {
+      return _current.pool == this ? _current.index : _workers.size();
+    }
+
+    bool take(Task &task) {
+      if (_queued.load(std::memory_order_acquire) == 0) {
+        return false;
+      }
+
+      const std::size_t self = own_queue();
+      {
+        std::lock_guard lock(_queues[self].mutex);
+        if (auto &tasks = _queues[self].tasks; !tasks.empty()) {
+          task = std::move(tasks.back());
+          tasks.pop_back();
+          _queued.fetch_sub(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+
+      for (std::size_t i = 1; i < queue_count(); i++) {
+        Queue &victim = _queues[(self + i) % queue_count()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+          task = std::move(victim.tasks.front());
+          victim.tasks.pop_front();
+          _queued.fetch_sub(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void work(std::size_t index) {
+      _current = {this, index};
+      while (true) {
+        if (run_pending()) {
+          continue;
+        }
+        std::unique_lock lock(_sleep_mutex);
+        _wake.wait(lock, [this] {
+          return _stop.load(std::memory_order_relaxed) || _queued.load(std::memory_order_relaxed) != 0;
+        });
+        if (_stop.load(std::memory_order_relaxed) && _queued.load(std::memory_order_relaxed) == 0) {
+          return;
+        }
+      }
+    }
+
+  public:
+    explicit ThreadPool(std::size_t threads) : _queues(std::make_unique<Queue[]>(threads + 1)) {
+      _workers.reserve(threads);
+      for (std::size_t i = 0; i < threads; i++) {
+        _workers.emplace_back([this, i] { work(i); });
+      }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    // queued tasks are finished before the workers exit
+    ~ThreadPool() noexcept {
+      {
+        std::lock_guard lock(_sleep_mutex);
+        _stop.store(true, std::memory_order_relaxed);
+      }
+      _wake.notify_all();
+      for (auto &worker : _workers) {
+        worker.join();
+      }
+    }
+
+    // process-wide pool, one thread per core counting the caller
+    static ThreadPool & global() {
+      static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+      return pool;
+    }
+
+    std::size_t size() const noexcept { return _workers.size(); }
+
+    void submit(Task task) {
+      {
+        Queue &queue = _queues[own_queue()];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        _queued.fetch_add(1, std::memory_order_release);
+      }
+      // taking the sleep lock orders this wakeup after a sleeper's predicate check
+      { std::lock_guard lock(_sleep_mutex); }
+      _wake.notify_one();
+    }
+
+    // runs one queued task on the calling thread
+    // returns false if there was nothing to run
+    bool run_pending() {
+      Task task;
+      if (!take(task)) {
+        return false;
+      }
+      task();
+      return true;
+    }
+  };
+
+  // fork/join scope over a ThreadPool
+  // wait() runs queued tasks until the group's own ones are done, so tasks may
+  // fork and wait recursively without exhausting the pool
+  struct TaskGroup {
+  private:
+    ThreadPool *_pool;
+    std::atomic<std::size_t> _pending = 0;
+
+  public:
+    explicit TaskGroup(ThreadPool &pool) noexcept : _pool(&pool) {}
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup & operator=(const TaskGroup &) = delete;
+
+    ~TaskGroup() { wait(); }
+
+    template <typename Fn>
+      TaskGroup & run(Fn fn) {
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        _pool->submit([this, fn = std::move(fn)]() mutable {
+          fn();
+          _pending.fetch_sub(1, std::memory_order_release);
+        });
+        return *this;
+      }
+
+    void wait() {
+      while (_pending.load(std::memory_order_acquire) != 0) {
+        if (!_pool->run_pending()) {
+          std::this_thread::yield();
+        }
+      }
+    }
+  };
+
+  // execution policy: algorithms overloaded on it fork work onto a ThreadPool
+  struct parallel_policy_t {
+    ThreadPool *pool = nullptr; // nullptr selects ThreadPool::global()
+
+    constexpr parallel_policy_t on(ThreadPool &executor) const noexcept { return {&executor}; }
+
+    ThreadPool & executor() const { return pool != nullptr ? *pool : ThreadPool::global(); }
+  };
+
+  inline constexpr parallel_policy_t par {};
+
+  // runs fn(chunk_begin, chunk_end) over [begin, end) split into chunks of at least
+  // grain indices, up to 4 per pool thread for balance; returns when all are done
+  template <typename Fn>
+    void parallel_for(const parallel_policy_t &policy, std::size_t begin, std::size_t end, std::size_t grain, Fn fn) {
+      if (begin >= end) {
+        return;
+      }
+      ThreadPool &pool = policy.executor();
+      const std::size_t count = end - begin;
+      const std::size_t chunks = std::clamp<std::size_t>(count / std::max<std::size_t>(grain, 1), 1, (pool.size() + 1) * 4);
+      if (chunks == 1) {
+        fn(begin, end);
+        return;
+      }
+      TaskGroup tasks(pool);
+      for (std::size_t i = 1; i < chunks; i++) {
+        tasks.run([&fn, begin, count, chunks, i] { fn(begin + count * i / chunks, begin + count * (i + 1) / chunks); });
+      }
+      fn(begin, begin + count / chunks);
+      tasks.wait();
+    }
+}
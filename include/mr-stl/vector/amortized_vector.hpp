@@ -3,38 +3,108 @@
 #include "mr-stl/vector/vector.hpp"
 
 namespace mr {
-  template <typename T>
-  struct AmortizedVector : FlatRangeMethods<AmortizedVector, T> {
+  template <typename T, std::size_t N, typename Allocator>
+    struct AmortizedVector;
+
+  namespace detail {
+    // binds non-type parameters so AmortizedVector fits range mixins' template template parameter
+    template <std::size_t N, typename Allocator>
+      struct AmortizedVectorOf {
+        template <typename U>
+          using type = AmortizedVector<U, N, Allocator>;
+      };
+  }
+
+  // small vector: up to N elements live inline in the object, on overflow
+  // all of them are moved to a heap mr::Vector; data() is contiguous in both modes
+  template <typename T, std::size_t N = 8, typename Allocator = HeapAllocator<T>>
+  struct AmortizedVector : FlatRangeMethods<detail::AmortizedVectorOf<N, Allocator>::template type, T>,
+                           RangeOutputOperators<detail::AmortizedVectorOf<N, Allocator>::template type, T> {
+    static_assert(N > 0, "inline capacity must be positive");
+
+    using allocator_type = Allocator;
+    static inline constexpr std::size_t inline_capacity = N;
+
     private:
-    static inline constexpr std::size_t initial_capacity = 2 * sizeof(std::size_t) - sizeof(char);
+    std::size_t _size = 0; // number of inline elements, unused once spilled
+    alignas(T) std::byte _sbuf[N * sizeof(T)];
+    mr::Vector<T, Allocator> _wbuf;
 
-    union {
-      struct {
-        char _size = 0;
-        T _data[initial_capacity] {};
-      } _sbuf = {};
-      mr::Vector<T> _wbuf;
-    } _buf;
+    T * sbuf() noexcept { return std::launder(reinterpret_cast<T *>(_sbuf)); }
+    const T * sbuf() const noexcept { return std::launder(reinterpret_cast<const T *>(_sbuf)); }
 
-    T* _data = buf.sbuf.data;
+    // moves inline elements to a heap buffer of at least `capacity` slots
+    bool spill(std::size_t capacity) {
+      _wbuf.reserve(capacity);
+      if (_wbuf.capacity() < capacity) [[unlikely]] {
+        return false;
+      }
+      _wbuf.move_range(sbuf(), sbuf() + _size);
+      std::destroy_n(sbuf(), _size);
+      _size = 0;
+      return true;
+    }
 
     public:
+    AmortizedVector() noexcept = default;
+
+    explicit AmortizedVector(const Allocator &alloc) noexcept : _wbuf(alloc) {}
+
+    template <typename ...Args>
+      requires (std::is_constructible_v<T, Args> && ...)
+      AmortizedVector(Args... args) {
+        reserve(sizeof...(args));
+        (emplace_back(static_cast<T>(args)), ...);
+      }
+
+    // copy semantic
+    AmortizedVector(const AmortizedVector &other) : _wbuf(other._wbuf) {
+      std::uninitialized_copy_n(other.sbuf(), other._size, sbuf());
+      _size = other._size;
+    }
+
+    AmortizedVector & operator=(const AmortizedVector &other) {
+      if (this != &other) {
+        *this = AmortizedVector(other);
+      }
+      return *this;
+    }
+
+    // move semantic
+    AmortizedVector(AmortizedVector &&other) noexcept : _wbuf(std::move(other._wbuf)) {
+      std::uninitialized_move_n(other.sbuf(), other._size, sbuf());
+      _size = other._size;
+      other.clear();
+    }
+
+    AmortizedVector & operator=(AmortizedVector &&other) noexcept {
+      if (this != &other) {
+        clear();
+        _wbuf = std::move(other._wbuf);
+        std::uninitialized_move_n(other.sbuf(), other._size, sbuf());
+        _size = other._size;
+        other.clear();
+      }
+      return *this;
+    }
+
+    ~AmortizedVector() noexcept { std::destroy_n(sbuf(), _size); }
+
     template <typename ...Args>
-      requires (std::is_constructible_v<T, Args...>)
       AmortizedVector & emplace_back(Args ...args) {
         // choose buffer to insert value into
-        if (_size < initial_capacity) [[likely]] {
-          buf[_size++] = {args...};
-        } else {
-          if (!_data) {
-            _data = Vector<T>(32);
+        if (!spilled()) [[likely]] {
+          if (_size < N) [[likely]] {
+            std::construct_at(sbuf() + _size, std::forward<Args>(args)...);
+            _size++;
+            return *this;
+          }
+          if (!spill(N * 2)) [[unlikely]] {
+            return *this;
           }
-
-          _data->emplace_back(args...);
-          _size++;
-          _capacity = initial_capacity + _data->capacity();
         }
 
+        _wbuf.emplace_back(std::forward<Args>(args)...);
         return *this;
       }
 
@@ -43,36 +113,70 @@ namespace mr {
       AmortizedVector & push_sorted(Args ...args) {
         emplace_back(args...);
         // insertion sort
-        std::size_t i = _size - 1; // last element index
+        std::size_t i = size() - 1; // last element index
         auto at = [this](auto idx) -> T& { return this->operator[](idx); };
 
-        T val = at(i);
+        T val = std::move(at(i));
         while (i > 0 && at(i - 1) > val) {
-          at(i) = at(i - 1);
+          at(i) = std::move(at(i - 1));
           i--;
         }
 
-        at(i) = val;
+        at(i) = std::move(val);
 
         return *this;
       }
 
-    // getters
-    std::size_t size() const noexcept { return _size; }
-    std::size_t capacity() const noexcept { return _capacity; }
-    const T* data() const noexcept { return buf; }
-    T* data() noexcept { return buf; }
-    T& operator[](std::size_t i) {
-      if (i < initial_capacity) [[likely]] {
-        return buf[i];
+    AmortizedVector & remove(std::size_t id) {
+      if (spilled()) {
+        _wbuf.remove(id);
+        return *this;
+      }
+      if (id >= _size) {
+        return *this;
       }
-      return _data.value()[i - initial_capacity];
+      _size--;
+      for (std::size_t i = id; i < _size; i++) {
+        sbuf()[i] = std::move(sbuf()[i + 1]);
+      }
+      std::destroy_at(sbuf() + _size);
+      return *this;
     }
-    T operator[](std::size_t i) const {
-      if (i < initial_capacity) [[likely]] {
-        return buf[i];
+
+    AmortizedVector & reserve(std::size_t new_size) {
+      if (new_size > capacity()) {
+        if (spilled()) {
+          _wbuf.reserve(new_size);
+        } else {
+          spill(new_size);
+        }
       }
-      return _data.value()[i - initial_capacity];
+      return *this;
+    }
+
+    // heap capacity is kept, so a spilled vector stays spilled
+    AmortizedVector & clear() {
+      std::destroy_n(sbuf(), _size);
+      _size = 0;
+      _wbuf.clear();
+      return *this;
+    }
+
+    // getters
+    bool spilled() const noexcept { return _wbuf.capacity() != 0; }
+    bool empty() const noexcept { return size() == 0; }
+    std::size_t size() const noexcept { return spilled() ? _wbuf.size() : _size; }
+    std::size_t capacity() const noexcept { return spilled() ? _wbuf.capacity() : N; }
+    const T * data() const noexcept { return spilled() ? _wbuf.data() : sbuf(); }
+    T * data() noexcept { return spilled() ? _wbuf.data() : sbuf(); }
+
+    Allocator get_allocator() const noexcept { return _wbuf.get_allocator(); }
+
+    T & operator[](std::size_t i) { return data()[i]; }
+    const T & operator[](std::size_t i) const { return data()[i]; }
+
+    bool operator==(const AmortizedVector &other) const noexcept {
+      return mr::equal(*this, other);
     }
   };
 }
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+
+#include "mr-stl/vector/segmented_vector.hpp"
+
+namespace mr {
+  // append-only vector safe for concurrent emplace_back and reads
+  // - writers reserve a slot with a single fetch_add, blocks are installed with a CAS
+  // - blocks never move, so growth is safe while other threads read
+  // - every slot has a ready flag; writers advance the published prefix over ready
+  //   slots instead of waiting for each other, so every index below size() is constructed
+  // - reads are wait-free: one atomic load of the block pointer
+  // Allocator has to be thread-safe (HeapAllocator is, arena/pool allocators are not)
+  template <typename T, typename Allocator = HeapAllocator<T>>
+    struct ConcurrentVector {
+      using allocator_type = Allocator;
+      using Layout = SegmentLayout<T>;
+
+    private:
+      std::atomic<std::size_t> _reserved = 0; // slots handed out to writers
+      std::atomic<std::size_t> _size = 0;     // length of the constructed prefix
+      // each block is block_size elements followed by block_size ready flags
+      std::array<std::atomic<T *>, Layout::max_blocks> _blocks {};
+      [[no_unique_address]] Allocator _alloc = {};
+
+      // block length in units of T, including the trailing flags
+      static constexpr std::size_t allocation_size(std::size_t id) noexcept {
+        const std::size_t n = Layout::block_size(id);
+        return n + (n * sizeof(std::atomic<bool>) + sizeof(T) - 1) / sizeof(T);
+      }
+
+      static std::atomic<bool> * ready_flags(T *block, std::size_t id) noexcept {
+        return reinterpret_cast<std::atomic<bool> *>(block + Layout::block_size(id));
+      }
+
+      T * block(std::size_t id) noexcept {
+        T *ptr = _blocks[id].load(std::memory_order_acquire);
+        if (ptr != nullptr) [[likely]] {
+          return ptr;
+        }
+
+        T *fresh = _alloc.allocate(allocation_size(id));
+        if (fresh == nullptr) [[unlikely]] {
+          // a reserved slot cannot be given back without stalling the published prefix
+          std::terminate();
+        }
+        std::uninitialized_value_construct_n(ready_flags(fresh, id), Layout::block_size(id));
+        if (_blocks[id].compare_exchange_strong(ptr, fresh,
+              std::memory_order_acq_rel, std::memory_order_acquire)) {
+          return fresh;
+        }
+        // another writer installed the block first
+        _alloc.deallocate(fresh, allocation_size(id));
+        return ptr;
+      }
+
+      bool ready(std::size_t index) const noexcept {
+        auto [id, offset] = Layout::locate(index);
+        T *ptr = _blocks[id].load(std::memory_order_acquire);
+        return ptr != nullptr && ready_flags(ptr, id)[offset].load(std::memory_order_seq_cst);
+      }
+
+    public:
+      ConcurrentVector() noexcept = default;
+
+      explicit ConcurrentVector(const Allocator &alloc) noexcept : _alloc(alloc) {}
+
+      ConcurrentVector(const ConcurrentVector &) = delete;
+      ConcurrentVector & operator=(const ConcurrentVector &) = delete;
+
+      ~ConcurrentVector() noexcept {
+        const std::size_t size = _size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < size; i++) {
+          std::destroy_at(&(*this)[i]);
+        }
+        for (std::size_t id = 0; id < Layout::max_blocks; id++) {
+          if (T *ptr = _blocks[id].load(std::memory_order_relaxed); ptr != nullptr) {
+            _alloc.deallocate(ptr, allocation_size(id));
+          }
+        }
+      }
+
+      // returns index of the new element
+      template <typename ...Args>
+        std::size_t emplace_back(Args ...args) {
+          const std::size_t index = _reserved.fetch_add(1, std::memory_order_relaxed);
+          auto [id, offset] = Layout::locate(index);
+          T *ptr = block(id);
+          std::construct_at(ptr + offset, std::forward<Args>(args)...);
+          // seq_cst pairs with the flag loads below: of two writers finishing out of
+          // order, at least one sees the other's flag and publishes both slots
+          ready_flags(ptr, id)[offset].store(true, std::memory_order_seq_cst);
+
+          // advance the published prefix over every ready slot (ours or someone else's)
+          std::size_t size = _size.load(std::memory_order_seq_cst);
+          while (size < _reserved.load(std::memory_order_relaxed) && ready(size)) {
+            if (_size.compare_exchange_weak(size, size + 1, std::memory_order_seq_cst)) {
+              size++;
+            }
+          }
+          return index;
+        }
+
+      // allocates blocks up front so emplace_back of the first n elements does not allocate
+      ConcurrentVector & reserve(std::size_t n) noexcept {
+        if (n == 0) {
+          return *this;
+        }
+        const std::size_t last = Layout::locate(n - 1).first;
+        for (std::size_t id = 0; id <= last; id++) {
+          block(id);
+        }
+        return *this;
+      }
+
+      // getters
+      std::size_t size() const noexcept { return _size.load(std::memory_order_acquire); }
+      bool empty() const noexcept { return size() == 0; }
+
+      Allocator get_allocator() const noexcept { return _alloc; }
+
+      // valid for any index below a previously observed size()
+      T & operator[](std::size_t i) noexcept {
+        auto [id, offset] = Layout::locate(i);
+        return _blocks[id].load(std::memory_order_acquire)[offset];
+      }
+      const T & operator[](std::size_t i) const noexcept {
+        auto [id, offset] = Layout::locate(i);
+        return _blocks[id].load(std::memory_order_acquire)[offset];
+      }
+
+      // calls f with a contiguous span per block over a snapshot of size()
+      template <typename Fn>
+        void for_each_segment(Fn &&f) const {
+          std::size_t left = size();
+          for (std::size_t id = 0; left != 0; id++) {
+            const std::size_t n = std::min(left, Layout::block_size(id));
+            f(std::span<const T>(_blocks[id].load(std::memory_order_acquire), n));
+            left -= n;
+          }
+        }
+    };
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <iterator>
+
+#include "mr-stl/def.hpp"
+#include "mr-stl/allocator/heap_allocator.hpp"
+
+namespace mr {
+  // geometry of segmented containers: block k holds first_block_size << k elements
+  template <typename T>
+    struct SegmentLayout {
+      // first block spans roughly 512 bytes
+      static inline constexpr std::size_t first_block_size =
+        std::bit_ceil(std::max<std::size_t>(1, 512 / sizeof(T)));
+      static inline constexpr std::size_t first_block_log = std::countr_zero(first_block_size);
+      // enough blocks to address the whole std::size_t range
+      static inline constexpr std::size_t max_blocks = sizeof(std::size_t) * 8 - first_block_log;
+
+      static constexpr std::size_t block_size(std::size_t block) noexcept {
+        return first_block_size << block;
+      }
+
+      // block index and offset of element i
+      static constexpr std::pair<std::size_t, std::size_t> locate(std::size_t i) noexcept {
+        const std::size_t shifted = i + first_block_size;
+        const std::size_t block = std::bit_width(shifted >> first_block_log) - 1;
+        return {block, shifted - (first_block_size << block)};
+      }
+    };
+
+  // vector built from geometrically growing blocks (see SegmentLayout)
+  // growth never moves elements, so pointers and references stay valid until removal,
+  // and emplace_back is O(1) worst case: the block table is fixed size and never reallocated
+  template <typename T, typename Allocator = HeapAllocator<T>>
+    struct SegmentedVector : RangeOutputOperators<SegmentedVector, T, Allocator> {
+      using allocator_type = Allocator;
+      using Layout = SegmentLayout<T>;
+
+      static inline constexpr std::size_t first_block_size = Layout::first_block_size;
+      static inline constexpr std::size_t max_blocks = Layout::max_blocks;
+
+    private:
+      std::size_t _size = 0;
+      std::array<T *, max_blocks> _blocks {};
+      [[no_unique_address]] Allocator _alloc = {};
+
+      static constexpr std::size_t block_size(std::size_t block) noexcept {
+        return Layout::block_size(block);
+      }
+
+      static constexpr std::pair<std::size_t, std::size_t> locate(std::size_t i) noexcept {
+        return Layout::locate(i);
+      }
+
+      template <bool Const>
+        struct Iterator {
+          using iterator_concept = std::random_access_iterator_tag;
+          using iterator_category = std::random_access_iterator_tag;
+          using value_type = T;
+          using difference_type = std::ptrdiff_t;
+          using reference = std::conditional_t<Const, const T &, T &>;
+          using pointer = std::conditional_t<Const, const T *, T *>;
+          using Owner = std::conditional_t<Const, const SegmentedVector, SegmentedVector>;
+
+          Owner *_owner = nullptr;
+          std::size_t _index = 0;
+
+          Iterator() noexcept = default;
+          Iterator(Owner *owner, std::size_t index) noexcept : _owner(owner), _index(index) {}
+
+          // iterator -> const_iterator, like standard containers
+          template <bool OtherConst> requires (Const && !OtherConst)
+            Iterator(const Iterator<OtherConst> &other) noexcept :
+              _owner(other._owner), _index(other._index) {}
+
+          reference operator*() const noexcept { return (*_owner)[_index]; }
+          pointer operator->() const noexcept { return &(*_owner)[_index]; }
+          reference operator[](difference_type n) const noexcept { return (*_owner)[_index + n]; }
+
+          Iterator & operator++() noexcept { ++_index; return *this; }
+          Iterator & operator--() noexcept { --_index; return *this; }
+          Iterator operator++(int) noexcept { auto tmp = *this; ++_index; return tmp; }
+          Iterator operator--(int) noexcept { auto tmp = *this; --_index; return tmp; }
+          Iterator & operator+=(difference_type n) noexcept { _index += n; return *this; }
+          Iterator & operator-=(difference_type n) noexcept { _index -= n; return *this; }
+
+          friend Iterator operator+(Iterator it, difference_type n) noexcept { return it += n; }
+          friend Iterator operator+(difference_type n, Iterator it) noexcept { return it += n; }
+          friend Iterator operator-(Iterator it, difference_type n) noexcept { return it -= n; }
+          friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept {
+            return static_cast<difference_type>(lhs._index) - static_cast<difference_type>(rhs._index);
+          }
+
+          friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+            return lhs._index == rhs._index;
+          }
+          friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) noexcept {
+            return lhs._index <=> rhs._index;
+          }
+        };
+
+    public:
+      using iterator = Iterator<false>;
+      using const_iterator = Iterator<true>;
+
+      SegmentedVector() noexcept = default;
+
+      explicit SegmentedVector(const Allocator &alloc) noexcept : _alloc(alloc) {}
+
+      template <typename ...Args>
+        requires (std::is_constructible_v<T, Args> && ...)
+        SegmentedVector(Args... args) {
+          (emplace_back(static_cast<T>(args)), ...);
+        }
+
+      // copy semantic
+      SegmentedVector(const SegmentedVector &other) : _alloc(other._alloc) {
+        other.for_each_segment([this](std::span<const T> segment) {
+          for (const T &elem : segment) {
+            emplace_back(elem);
+          }
+        });
+      }
+
+      SegmentedVector & operator=(const SegmentedVector &other) {
+        if (this != &other) {
+          *this = SegmentedVector(other);
+        }
+        return *this;
+      }
+
+      // move semantic
+      SegmentedVector(SegmentedVector &&other) noexcept :
+        _size(std::exchange(other._size, 0)),
+        _blocks(std::exchange(other._blocks, {})),
+        _alloc(other._alloc) {}
+
+      SegmentedVector & operator=(SegmentedVector &&other) noexcept {
+        if (this != &other) {
+          release();
+          _size = std::exchange(other._size, 0);
+          _blocks = std::exchange(other._blocks, {});
+          _alloc = other._alloc;
+        }
+        return *this;
+      }
+
+      ~SegmentedVector() noexcept { release(); }
+
+      template <typename ...Args>
+        SegmentedVector & emplace_back(Args ...args) {
+          auto [block, offset] = locate(_size);
+          if (_blocks[block] == nullptr) [[unlikely]] {
+            if (_blocks[block] = _alloc.allocate(block_size(block)); _blocks[block] == nullptr) {
+              return *this;
+            }
+          }
+          std::construct_at(_blocks[block] + offset, std::forward<Args>(args)...);
+          _size++;
+          return *this;
+        }
+
+      SegmentedVector & pop_back() {
+        if (_size == 0) {
+          return *this;
+        }
+        _size--;
+        std::destroy_at(&(*this)[_size]);
+        return *this;
+      }
+
+      // allocated blocks are kept for reuse
+      SegmentedVector & clear() {
+        for_each_segment([](std::span<T> segment) {
+          std::destroy(segment.begin(), segment.end());
+        });
+        _size = 0;
+        return *this;
+      }
+
+      // calls f with a contiguous span per used block, in order
+      // (the fast path for bulk processing: every span is a plain array)
+      template <typename Fn>
+        void for_each_segment(Fn &&f) {
+          std::size_t left = _size;
+          for (std::size_t block = 0; left != 0; block++) {
+            const std::size_t n = std::min(left, block_size(block));
+            f(std::span<T>(_blocks[block], n));
+            left -= n;
+          }
+        }
+
+      template <typename Fn>
+        void for_each_segment(Fn &&f) const {
+          std::size_t left = _size;
+          for (std::size_t block = 0; left != 0; block++) {
+            const std::size_t n = std::min(left, block_size(block));
+            f(std::span<const T>(_blocks[block], n));
+            left -= n;
+          }
+        }
+
+      // getters
+      std::size_t size() const noexcept { return _size; }
+      bool empty() const noexcept { return _size == 0; }
+
+      std::size_t capacity() const noexcept {
+        std::size_t blocks = 0;
+        while (blocks < max_blocks && _blocks[blocks] != nullptr) {
+          blocks++;
+        }
+        return first_block_size * ((std::size_t(1) << blocks) - 1);
+      }
+
+      Allocator get_allocator() const noexcept { return _alloc; }
+
+      T & operator[](std::size_t i) noexcept {
+        auto [block, offset] = locate(i);
+        return _blocks[block][offset];
+      }
+      const T & operator[](std::size_t i) const noexcept {
+        auto [block, offset] = locate(i);
+        return _blocks[block][offset];
+      }
+
+      friend iterator begin(SegmentedVector &self) noexcept { return {&self, 0}; }
+      friend iterator end(SegmentedVector &self) noexcept { return {&self, self._size}; }
+      friend const_iterator begin(const SegmentedVector &self) noexcept { return {&self, 0}; }
+      friend const_iterator end(const SegmentedVector &self) noexcept { return {&self, self._size}; }
+      friend const_iterator cbegin(const SegmentedVector &self) noexcept { return {&self, 0}; }
+      friend const_iterator cend(const SegmentedVector &self) noexcept { return {&self, self._size}; }
+
+    private:
+      void release() noexcept {
+        clear();
+        for (std::size_t block = 0; block < max_blocks && _blocks[block] != nullptr; block++) {
+          _alloc.deallocate(_blocks[block], block_size(block));
+          _blocks[block] = nullptr;
+        }
+      }
+    };
+}
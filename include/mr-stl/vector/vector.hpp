@@ -1,37 +1,75 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <ranges>
 
 #include "mr-stl/def.hpp"
+#include "mr-stl/algorithm/search.hpp"
 #include "mr-stl/span/span.hpp"
+#include "mr-stl/allocator/heap_allocator.hpp"
 
 namespace mr {
-  template <typename T>
-    struct Vector : FlatRangeMethods<Vector, T>,
-                    RangeOutputOperators<Vector, T> {
+  template <typename T, typename Allocator = HeapAllocator<T>>
+    struct Vector : FlatRangeMethods<Vector, T, Allocator>,
+                    RangeOutputOperators<Vector, T, Allocator> {
+      using allocator_type = Allocator;
+      // only [0, _size) slots hold live objects, the rest of capacity is raw memory
+      using Storage = OwningSpan<T, Allocator, uninitialized_storage_t>;
+
       std::size_t _size = 0;
-      OwningSpan<T> _data = {};
+      Storage _data = {};
 
       Vector() noexcept = default;
-      ~Vector() noexcept = default;
+      ~Vector() noexcept { std::destroy_n(data(), _size); }
+
+      explicit Vector(const Allocator &alloc) noexcept :
+        _data(alloc) {}
 
       template <typename ...Args>
         requires (std::is_constructible_v<T, Args> && ...)
-        Vector(Args... args) : _data(static_cast<T>(args)...), _size(sizeof...(args)) {}
+        Vector(Args... args) : _data(sizeof...(args)) {
+          if (data() != nullptr) [[likely]] {
+            (std::construct_at(data() + _size++, static_cast<T>(args)), ...);
+          }
+        }
 
-      Vector(std::size_t size) :
-        _data(size) {}
+      Vector(std::size_t size, const Allocator &alloc = {}) :
+        _data(size, alloc) {}
 
-      Vector(const T *data, std::size_t size) :
-        _data(data, size), _size(size) {}
+      Vector(const T *data, std::size_t size, const Allocator &alloc = {}) :
+        _data(size, alloc) {
+          if (this->data() != nullptr) [[likely]] {
+            std::uninitialized_copy_n(data, size, this->data());
+            _size = size;
+          }
+        }
 
       // copy semantic
-      Vector(const Vector &other) noexcept = default;
-      Vector & operator=(const Vector &other) noexcept = default;
+      Vector(const Vector &other) noexcept :
+        Vector(other.data(), other._size, other.get_allocator()) {}
+
+      Vector & operator=(const Vector &other) noexcept {
+        if (this != &other) {
+          *this = Vector(other);
+        }
+        return *this;
+      }
 
       // move semantic
-      Vector(Vector &&other) noexcept = default;
-      Vector & operator=(Vector &&other) noexcept = default;
+      Vector(Vector &&other) noexcept :
+        _size(std::exchange(other._size, 0)), _data(std::move(other._data)) {}
+
+      Vector & operator=(Vector &&other) noexcept {
+        if (this != &other) {
+          clear();
+          _data = std::move(other._data);
+          _size = std::exchange(other._size, 0);
+        }
+        return *this;
+      }
 
       template <typename ...Args>
         // requires (std::is_constructible_v<T, Args...>)
@@ -39,21 +77,92 @@ namespace mr {
           while (_size >= _data.size()) [[unlikely]] {
             try_resize();
           }
-          T tmp = {std::forward<Args>(args)...};
-          _data[_size++] = std::move(tmp);
+          std::construct_at(data() + _size, std::forward<Args>(args)...);
+          _size++;
           return *this;
         }
 
       template <std::input_iterator It>
         Vector & move_range(It begin, It end) {
-          std::size_t new_size = std::distance(begin, end);
-          while (_data.size() < new_size) {
-            try_resize();
+          return append_range(std::make_move_iterator(begin), std::make_move_iterator(end));
+        }
+
+      // bulk append: forward ranges are sized up front and stored with a single reallocation
+      template <std::input_iterator It, std::sentinel_for<It> S>
+        Vector & append_range(It first, S last) {
+          if constexpr (std::forward_iterator<It>) {
+            const std::size_t count = std::ranges::distance(first, last);
+            if (_size + count > capacity() && aliases(first)) [[unlikely]] {
+              // the source lives in the buffer about to be released
+              reallocate_around(_size, first, count);
+              return *this;
+            }
+            if (!grow_for(count)) [[unlikely]] {
+              return *this;
+            }
+            copy_construct(first, count, data() + _size);
+            _size += count;
+          } else {
+            for (; first != last; ++first) {
+              emplace_back(*first);
+            }
           }
-          std::uninitialized_move(begin, end, _data.data());
           return *this;
         }
 
+      Vector & append_range(const Range auto &range) {
+        return append_range(begin(range), end(range));
+      }
+
+      Vector & append_n(std::size_t count, T value) {
+        if (!grow_for(count)) [[unlikely]] {
+          return *this;
+        }
+        std::uninitialized_fill_n(data() + _size, count, value);
+        _size += count;
+        return *this;
+      }
+
+      // inserts [first, last) before position, at most one reallocation
+      template <std::forward_iterator It, std::sentinel_for<It> S>
+        Vector & insert_range(std::size_t pos, It first, S last) {
+          if (pos >= _size) {
+            return append_range(first, last);
+          }
+
+          const std::size_t count = std::ranges::distance(first, last);
+          const bool aliased = aliases(first);
+          if (_size + count > capacity() && aliased) [[unlikely]] {
+            reallocate_around(pos, first, count);
+            return *this;
+          }
+          if (!grow_for(count)) [[unlikely]] {
+            return *this;
+          }
+
+          T *gap = data() + pos;
+          if constexpr (is_trivially_relocatable_v<T>) {
+            if (!aliased) [[likely]] {
+              // open the gap bitwise, leaving raw slots behind
+              std::memmove(static_cast<void *>(gap + count), gap, (_size - pos) * sizeof(T));
+              copy_construct(first, count, gap);
+              _size += count;
+              return *this;
+            }
+          }
+          // append, then rotate the new elements into place: the source is read before
+          // anything shifts
+          copy_construct(first, count, data() + _size);
+          _size += count;
+          std::rotate(gap, data() + _size - count, data() + _size);
+          return *this;
+        }
+
+      template <std::forward_iterator It, std::sentinel_for<It> S>
+        Vector & insert_range(const T *location, It first, S last) {
+          return insert_range(std::distance(const_cast<const T *>(data()), location), first, last);
+        }
+
       template <typename ...Args>
         requires (std::is_constructible_v<T, Args...>)
         Vector & push_sorted(Args ...args) {
@@ -97,27 +206,85 @@ namespace mr {
         }
         _size--;
         for (std::size_t i = id; i < _size; i++) {
-          _data[i] = _data[i + 1];
+          _data[i] = std::move(_data[i + 1]);
+        }
+        std::destroy_at(data() + _size);
+        return *this;
+      }
+
+      // O(1) removal, the last element takes the place of the removed one
+      Vector & swap_remove(std::size_t id) {
+        if (id >= _size) {
+          return *this;
+        }
+        _size--;
+        if (id != _size) {
+          _data[id] = std::move(_data[_size]);
         }
+        std::destroy_at(data() + _size);
+        return *this;
+      }
+
+      // stable single pass compaction
+      template <typename Pred> requires (std::is_invocable_r_v<bool, Pred, const T &>)
+        Vector & erase_if(Pred &&pred) {
+          T *first = std::find_if(data(), data() + _size, pred);
+          T *last = data() + _size;
+          if (first == last) {
+            return *this;
+          }
+          for (T *it = first + 1; it != last; ++it) {
+            if (!pred(std::as_const(*it))) {
+              *first++ = std::move(*it);
+            }
+          }
+          shrink_to(first - data());
+          return *this;
+        }
+
+      // stable removal of the elements at ascending indices (duplicates and
+      // out of range indices are skipped) in a single pass
+      Vector & remove_indices(std::span<const std::size_t> sorted_ids) {
+        auto id = sorted_ids.begin();
+        if (id == sorted_ids.end() || *id >= _size) {
+          return *this;
+        }
+
+        std::size_t write = *id;
+        for (std::size_t read = *id; read < _size; read++) {
+          if (id != sorted_ids.end() && *id == read) {
+            // skip all duplicates of the current index
+            while (id != sorted_ids.end() && *id == read) {
+              ++id;
+            }
+            continue;
+          }
+          _data[write++] = std::move(_data[read]);
+        }
+        shrink_to(write);
         return *this;
       }
 
       Vector & reserve(std::size_t new_size) {
-        while (_data.size() < new_size) [[unlikely]] {
-          try_resize();
+        if (_data.size() < new_size) [[unlikely]] {
+          reallocate(new_size);
         }
         return *this;
       }
 
       Vector & resize(std::size_t new_size, const T &init = {}) {
-        reserve(new_size);
-        std::uninitialized_fill_n(begin(_data) + _size, new_size - _size, init);
-        _size = new_size;
+        if (new_size < _size) {
+          shrink_to(new_size);
+        } else {
+          reserve(new_size);
+          std::uninitialized_fill_n(data() + _size, new_size - _size, init);
+          _size = new_size;
+        }
         return *this;
       }
 
       Vector & clear() {
-        _size = 0;
+        shrink_to(0);
         return *this;
       }
 
@@ -128,42 +295,127 @@ namespace mr {
       std::size_t size() const noexcept {return _size; }
       std::size_t capacity() const noexcept {return _data.size(); }
 
+      Allocator get_allocator() const noexcept { return _data.get_allocator(); }
+
       T& operator[](std::size_t i) { return _data[i]; }
       const T & operator[](std::size_t i) const { return _data[i]; }
 
       // setters
+      // does not construct or destroy anything: slots in [min, max) of old and new size
+      // must be constructed/destroyed by the caller
       constexpr Vector & size(std::size_t s) noexcept {
         _size = s;
         return *this;
       }
 
-      bool operator<(const Vector<T> &other) const noexcept {
+      bool operator<(const Vector &other) const noexcept {
         if (_size != other._size) {
           return _size < other._size;
         }
 
-        return std::memcmp(_data.data(), other.data(), _size * sizeof(T)) < 0;
+        return mr::lexicographical_compare(*this, other);
       }
 
-      bool operator==(const Vector<T> &other) const noexcept {
-        if (_size != other._size) {
-          return false;
-        }
-        return std::memcmp(_data.data(), other.data(), _size * sizeof(T)) == 0;
+      bool operator==(const Vector &other) const noexcept {
+        return mr::equal(*this, other);
       }
 
     private:
-      std::optional<OwningSpan<T>> resized(const std::size_t size) {
-        if (T *tmp = new (std::nothrow) T[size]; tmp != nullptr) [[likely]] {
+      std::optional<Storage> resized(const std::size_t size) {
+        if (Storage tmp(size, _data.get_allocator());
+            tmp.data() != nullptr) [[likely]] {
           // move on successful allocation
-          std::uninitialized_move_n(_data.data(), _data.size(), tmp);
-          return OwningSpan(tmp, size);
+          std::uninitialized_move_n(_data.data(), _size, tmp.data());
+          std::destroy_n(_data.data(), _size);
+          return tmp;
         }
         return std::nullopt;
       }
 
+      // destroys trailing elements past new_size
+      void shrink_to(const std::size_t new_size) noexcept {
+        std::destroy_n(data() + new_size, _size - new_size);
+        _size = new_size;
+      }
+
+      bool reallocate(const std::size_t size) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+          // grow in place or relocate bitwise, no per-element moves
+          return _data.reallocate(size);
+        } else {
+          if (auto tmp = resized(size); tmp.has_value()) [[likely]] {
+            _data = std::move(*tmp);
+            return true;
+          }
+          return false;
+        }
+      }
+
       void try_resize() {
-        _data = resized(capacity() * 2 + 1).value_or(std::move(_data)); // assign new value on success
+        reallocate(capacity() * 2 + 1);
       }
+
+      // make room for count more elements, keeping geometric growth
+      bool grow_for(const std::size_t count) {
+        const std::size_t required = _size + count;
+        if (required <= capacity()) [[likely]] {
+          return true;
+        }
+        return reallocate(std::max(required, capacity() * 2 + 1));
+      }
+
+      // whether a contiguous source starts inside our live elements
+      template <typename It>
+        bool aliases(It first) const noexcept {
+          if constexpr (std::contiguous_iterator<It>) {
+            const void *src = std::to_address(first);
+            return !std::less<const void *>{}(src, data()) &&
+                   std::less<const void *>{}(src, data() + _size);
+          } else {
+            return false;
+          }
+        }
+
+      // grows into a fresh buffer with count copies of first at pos, reading the source
+      // before the old buffer is released
+      template <std::forward_iterator It>
+        bool reallocate_around(const std::size_t pos, It first, const std::size_t count) {
+          Storage tmp(std::max(_size + count, capacity() * 2 + 1), _data.get_allocator());
+          if (tmp.data() == nullptr) [[unlikely]] {
+            return false;
+          }
+          copy_construct(first, count, tmp.data() + pos);
+          relocate(data(), pos, tmp.data());
+          relocate(data() + pos, _size - pos, tmp.data() + pos + count);
+          _data = std::move(tmp);
+          _size += count;
+          return true;
+        }
+
+      // moves count live elements into raw slots, leaving raw slots behind
+      static void relocate(T *src, std::size_t count, T *dst) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+          if (count != 0) {
+            std::memcpy(static_cast<void *>(dst), src, count * sizeof(T));
+          }
+        } else {
+          std::uninitialized_move_n(src, count, dst);
+          std::destroy_n(src, count);
+        }
+      }
+
+      // copies count elements starting at first into raw slots
+      template <std::forward_iterator It>
+        static void copy_construct(It first, std::size_t count, T *dst) {
+          if constexpr (std::contiguous_iterator<It> &&
+                        std::is_trivially_copyable_v<T> &&
+                        std::is_same_v<std::iter_value_t<It>, T>) {
+            if (count != 0) {
+              std::memcpy(static_cast<void *>(dst), std::to_address(first), count * sizeof(T));
+            }
+          } else {
+            std::uninitialized_copy_n(first, count, dst);
+          }
+        }
     };
 }
@@ -1,5 +1,14 @@
 #include <mr-stl/mr-stl.hpp>
 
+#include <bit>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
 #include "gtest/gtest.h"
 
 template <typename T>
@@ -19,20 +28,6 @@ struct MVector {
   std::size_t size() const noexcept { return vec.size(); }
 };
 
-template <typename T>
-struct LFVector {
-  std::atomic<int> af;
-  mr::Vector<T> vec;
-
-  template <typename ...Ts>
-    LFVector & emplace_back(Ts ...args) {
-      vec.emplace_back(args...);
-      return *this;
-    }
-
-  std::size_t size() const noexcept { return vec.size(); }
-};
-
 int test_body(auto && vec) {
   constexpr int threads_num = 100;
   constexpr int thread_work = 100;
@@ -58,6 +53,51 @@ TEST(MVectorTest, PushBackTest) {
   EXPECT_EQ(size, vec.size());
 }
 
+TEST(ConcurrentVectorTest, PushBackTest) {
+  mr::ConcurrentVector<int> vec;
+  auto size = test_body(vec);
+  ASSERT_EQ(size, vec.size());
+
+  // every thread pushed 0..99 once
+  std::array<int, 100> counts {};
+  vec.for_each_segment([&counts](std::span<const int> segment) {
+    for (int x : segment) {
+      counts[x]++;
+    }
+  });
+  for (int count : counts) {
+    EXPECT_EQ(count, 100);
+  }
+}
+
+TEST(ConcurrentVectorTest, ReadWhileGrowing) {
+  mr::ConcurrentVector<std::size_t> vec;
+  std::atomic<bool> done = false;
+  std::atomic<bool> consistent = true;
+
+  std::thread reader([&]() {
+    while (!done.load()) {
+      const std::size_t size = vec.size();
+      for (std::size_t i = 0; i < size; i += 97) {
+        if (vec[i] != i) {
+          consistent = false;
+        }
+      }
+    }
+  });
+  std::thread writer([&]() {
+    for (std::size_t i = 0; i < 100000; i++) {
+      vec.emplace_back(i);
+    }
+    done = true;
+  });
+  writer.join();
+  reader.join();
+
+  EXPECT_TRUE(consistent.load());
+  EXPECT_EQ(vec.size(), 100000);
+}
+
 TEST(VectorSortTest, VectorSortTest) {
   mr::Vector<int> vec {
     93, 2, 46, 41, 24, 15, 83, 19, 29, 73, 99, 92, 79, 23, 13, 34, 40, 5, 90, 91, 7, 80, 55, 43, 31, 48, 96, 33, 17, 97, 1, 56, 9, 76, 58, 59, 57, 11, 82, 32, 22, 71, 88, 68, 66, 63, 50, 72, 44, 77, 64, 69, 94, 36, 12, 87, 37, 18, 16, 49, 51, 78, 84, 62, 60, 47, 35, 21, 89, 98, 10, 65, 28, 45, 3, 14, 25, 39, 95, 20, 81, 54, 70, 74, 42, 100, 67, 8, 38, 30, 75, 86, 61, 4, 6, 26, 52, 27, 53, 85
@@ -69,6 +109,1242 @@ TEST(VectorSortTest, VectorSortTest) {
   EXPECT_EQ(vec, vec_res);
 }
 
+TEST(VectorSortTest, Patterns) {
+  const int size = 10000;
+  std::mt19937 gen(42);
+  std::vector<std::vector<int>> inputs;
+  inputs.reserve(8);
+  auto &random = inputs.emplace_back(size);
+  for (auto &x : random) { x = static_cast<int>(gen()); }
+  auto &sorted = inputs.emplace_back(size);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  inputs.emplace_back(sorted.rbegin(), sorted.rend());
+  auto &organ_pipe = inputs.emplace_back(size);
+  for (int i = 0; i < size; i++) { organ_pipe[i] = std::min(i, size - i); }
+  auto &few_unique = inputs.emplace_back(size);
+  for (auto &x : few_unique) { x = static_cast<int>(gen() % 4); }
+  auto &sawtooth = inputs.emplace_back(size);
+  for (int i = 0; i < size; i++) { sawtooth[i] = i % 100; }
+  inputs.emplace_back(size, 7);
+
+  for (auto &input : inputs) {
+    auto expected = input;
+    std::sort(expected.begin(), expected.end());
+    mr::sort(input);
+    EXPECT_EQ(input, expected);
+  }
+}
+
+TEST(VectorSortTest, NonArithmetic) {
+  std::mt19937 gen(7);
+  mr::Vector<std::string> vec;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3000; i++) {
+    auto str = std::to_string(gen() % 500);
+    vec.emplace_back(str);
+    expected.push_back(str);
+  }
+  mr::sort(vec);
+  std::sort(expected.begin(), expected.end());
+  ASSERT_EQ(vec.size(), expected.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), vec.data()));
+}
+
+TEST(VectorSortTest, SmallSizes) {
+  std::mt19937 gen(3);
+  for (int size = 0; size < 300; size++) {
+    std::vector<double> vec(size);
+    for (auto &x : vec) { x = static_cast<double>(gen() % 64) / 4; }
+    mr::sort(vec);
+    EXPECT_TRUE(std::is_sorted(vec.begin(), vec.end())) << size;
+  }
+}
+
+TEST(VectorSortTest, Parallel) {
+  mr::ThreadPool pool(3);
+  std::mt19937 gen(11);
+  mr::Vector<int> vec;
+  vec.reserve(1 << 20);
+  for (int i = 0; i < (1 << 20); i++) {
+    vec.emplace_back(static_cast<int>(gen() % 100000));
+  }
+  std::vector<int> expected(vec.data(), vec.data() + vec.size());
+  std::sort(expected.begin(), expected.end());
+
+  mr::sort(mr::par.on(pool), vec);
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), vec.data()));
+
+  // already sorted and all equal inputs take the early exits
+  mr::sort(mr::par.on(pool), vec);
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), vec.data()));
+  std::vector<double> same(1 << 18, 1.5);
+  mr::sort(mr::par, same);
+  EXPECT_TRUE(std::all_of(same.begin(), same.end(), [](double x) { return x == 1.5; }));
+}
+
+template <typename T>
+static void check_radix_sort(std::size_t size) {
+  std::mt19937_64 gen(size);
+  std::vector<T> vec(size);
+  for (auto &x : vec) {
+    if constexpr (std::is_floating_point_v<T>) {
+      x = static_cast<T>(std::uniform_real_distribution<double>(-1e6, 1e6)(gen));
+    } else {
+      x = static_cast<T>(gen());
+    }
+  }
+  auto expected = vec;
+  std::sort(expected.begin(), expected.end());
+  mr::radix_sort(vec);
+  EXPECT_EQ(vec, expected);
+}
+
+TEST(RadixSortTest, KeyTypes) {
+  for (std::size_t size : {0, 1, 100, 5000, 70000}) {
+    check_radix_sort<std::int8_t>(size);
+    check_radix_sort<std::uint16_t>(size);
+    check_radix_sort<int>(size);
+    check_radix_sort<std::uint32_t>(size);
+    check_radix_sort<std::int64_t>(size);
+    check_radix_sort<std::uint64_t>(size);
+    check_radix_sort<float>(size);
+    check_radix_sort<double>(size);
+  }
+}
+
+TEST(RadixSortTest, FloatSpecialValues) {
+  const float inf = std::numeric_limits<float>::infinity();
+  mr::Vector<float> vec {3.5f, -0.0f, inf, -1.0f, 0.0f, -inf, 1e-30f, -1e30f};
+  mr::radix_sort(vec);
+  EXPECT_TRUE(std::is_sorted(vec.data(), vec.data() + vec.size()));
+  EXPECT_EQ(vec[0], -inf);
+  EXPECT_EQ(vec[7], inf);
+}
+
+TEST(RadixSortTest, KeyExtractorIsStable) {
+  struct Event {
+    std::uint32_t timestamp;
+    int id;
+  };
+  std::mt19937 gen(5);
+  std::vector<Event> events;
+  for (int i = 0; i < 20000; i++) {
+    events.push_back({static_cast<std::uint32_t>(gen() % 1000), i});
+  }
+  mr::radix_sort(events, [](const Event &e) { return e.timestamp; });
+  for (std::size_t i = 1; i < events.size(); i++) {
+    ASSERT_LE(events[i - 1].timestamp, events[i].timestamp);
+    if (events[i - 1].timestamp == events[i].timestamp) {
+      ASSERT_LT(events[i - 1].id, events[i].id);
+    }
+  }
+}
+
+TEST(RadixSortTest, NonDefaultConstructible) {
+  struct Named {
+    Named(int key, std::string name) : key(key), name(std::move(name)) {}
+    int key;
+    std::string name;
+  };
+  std::mt19937 gen(8);
+  std::vector<Named> records;
+  for (int i = 0; i < 5000; i++) {
+    const int key = static_cast<int>(gen() % 100000) - 50000;
+    records.emplace_back(key, std::string(20, 'a') + std::to_string(key));
+  }
+
+  auto sorted = records;
+  mr::sort(sorted, std::less<>{}, &Named::key);
+  auto stable = records;
+  mr::radix_sort(stable, &Named::key);
+  for (std::size_t i = 1; i < records.size(); i++) {
+    ASSERT_LE(sorted[i - 1].key, sorted[i].key);
+    ASSERT_EQ(sorted[i].name, std::string(20, 'a') + std::to_string(sorted[i].key));
+    ASSERT_EQ(stable[i].key, sorted[i].key);
+    ASSERT_EQ(stable[i].name, sorted[i].name);
+  }
+}
+
+struct SortRecord {
+  int key;
+  int order;
+};
+
+TEST(SortCustomTest, ComparatorAndProjection) {
+  std::mt19937 gen(21);
+  std::vector<SortRecord> records;
+  for (int i = 0; i < 5000; i++) {
+    records.push_back({static_cast<int>(gen() % 1000), i});
+  }
+
+  auto by_key = records;
+  mr::sort(by_key, std::less<>{}, &SortRecord::key);
+  EXPECT_TRUE(std::is_sorted(by_key.begin(), by_key.end(),
+    [](const SortRecord &a, const SortRecord &b) { return a.key < b.key; }));
+
+  auto descending = records;
+  mr::sort(descending, std::greater<>{}, [](const SortRecord &r) { return r.order; });
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_EQ(descending[i].order, 4999 - i);
+  }
+
+  std::vector<double> values(3000);
+  for (auto &x : values) { x = static_cast<double>(gen() % 100000) / 7; }
+  mr::sort(values, std::greater<>{});
+  EXPECT_TRUE(std::is_sorted(values.rbegin(), values.rend()));
+
+  mr::ThreadPool pool(2);
+  mr::Vector<SortRecord> big;
+  for (int i = 0; i < 100000; i++) {
+    big.emplace_back(SortRecord{static_cast<int>(gen()), i});
+  }
+  mr::sort(mr::par.on(pool), big, std::less<>{}, &SortRecord::key);
+  EXPECT_TRUE(std::is_sorted(big.data(), big.data() + big.size(),
+    [](const SortRecord &a, const SortRecord &b) { return a.key < b.key; }));
+}
+
+TEST(SortCustomTest, PartitionComparator) {
+  std::vector<int> vec {5, 1, 9, 3, 7, 2, 8};
+  auto pivot = mr::partition(vec.begin(), vec.end(), std::greater<>{});
+  EXPECT_TRUE(std::all_of(vec.begin(), pivot, [&](int x) { return x > *pivot; }));
+  EXPECT_TRUE(std::all_of(pivot + 1, vec.end(), [&](int x) { return x <= *pivot; }));
+}
+
+static void check_stable_sort(std::vector<SortRecord> records, mr::Vector<SortRecord> &scratch) {
+  mr::stable_sort(records, scratch, std::less<>{}, &SortRecord::key);
+  for (std::size_t i = 1; i < records.size(); i++) {
+    ASSERT_LE(records[i - 1].key, records[i].key);
+    if (records[i - 1].key == records[i].key) {
+      ASSERT_LT(records[i - 1].order, records[i].order);
+    }
+  }
+}
+
+TEST(StableSortTest, Patterns) {
+  std::mt19937 gen(17);
+  mr::Vector<SortRecord> scratch;
+  for (int size : {0, 1, 2, 63, 64, 65, 1000, 30000}) {
+    std::vector<SortRecord> random, nearly_sorted, descending, sawtooth;
+    for (int i = 0; i < size; i++) {
+      random.push_back({static_cast<int>(gen() % 100), i});
+      nearly_sorted.push_back({i / 3, i});
+      descending.push_back({(size - i) / 2, i});
+      sawtooth.push_back({i % 500, i});
+    }
+    for (int i = 0; i < size / 100; i++) {
+      std::swap(nearly_sorted[gen() % size].key, nearly_sorted[gen() % size].key);
+    }
+    check_stable_sort(random, scratch);
+    check_stable_sort(nearly_sorted, scratch);
+    check_stable_sort(descending, scratch);
+    check_stable_sort(sawtooth, scratch);
+  }
+  // the scratch buffer only ever holds the shorter side of a merge
+  EXPECT_LE(scratch.capacity(), 30000u);
+  EXPECT_EQ(scratch.size(), 0u);
+}
+
+TEST(StableSortTest, NonTrivialElements) {
+  std::mt19937 gen(2);
+  std::vector<std::string> words, expected;
+  for (int i = 0; i < 4000; i++) {
+    words.push_back(std::to_string(gen() % 700));
+  }
+  expected = words;
+  std::stable_sort(expected.begin(), expected.end(),
+    [](const std::string &a, const std::string &b) { return a.size() < b.size(); });
+  mr::stable_sort(words, std::less<>{}, [](const std::string &s) { return s.size(); });
+  EXPECT_EQ(words, expected);
+}
+
+TEST(SelectTest, NthElement) {
+  std::mt19937 gen(8);
+  for (int size : {1, 2, 23, 24, 100, 5000, 100000}) {
+    std::vector<int> random, few_unique, sorted, equal(size, 7);
+    for (int i = 0; i < size; i++) {
+      random.push_back(static_cast<int>(gen()));
+      few_unique.push_back(static_cast<int>(gen() % 4));
+      sorted.push_back(i);
+    }
+    for (auto *input : {&random, &few_unique, &sorted, &equal}) {
+      auto expected = *input;
+      std::sort(expected.begin(), expected.end());
+      for (int nth : {0, size / 2, size * 99 / 100, size - 1}) {
+        auto vec = *input;
+        mr::nth_element(vec, vec.begin() + nth);
+        ASSERT_EQ(vec[nth], expected[nth]) << size << ' ' << nth;
+        ASSERT_TRUE(std::all_of(vec.begin(), vec.begin() + nth, [&](int x) { return x <= vec[nth]; }));
+        ASSERT_TRUE(std::all_of(vec.begin() + nth, vec.end(), [&](int x) { return x >= vec[nth]; }));
+      }
+    }
+  }
+
+  std::vector<SortRecord> records;
+  for (int i = 0; i < 3000; i++) {
+    records.push_back({static_cast<int>(gen() % 100), i});
+  }
+  mr::nth_element(records, records.begin() + 2970, std::greater<>{}, &SortRecord::key);
+  EXPECT_TRUE(std::all_of(records.begin() + 2970, records.end(),
+    [&](const SortRecord &r) { return r.key <= records[2970].key; }));
+}
+
+TEST(SelectTest, PartialSortAndTopK) {
+  std::mt19937 gen(4);
+  std::vector<double> latencies(20000);
+  for (auto &x : latencies) {
+    x = std::exponential_distribution<double>(0.1)(gen);
+  }
+  auto expected = latencies;
+  std::sort(expected.begin(), expected.end());
+
+  auto vec = latencies;
+  mr::partial_sort(vec, vec.begin() + 100);
+  EXPECT_TRUE(std::equal(vec.begin(), vec.begin() + 100, expected.begin()));
+  vec = latencies;
+  mr::partial_sort(vec, vec.end());
+  EXPECT_EQ(vec, expected);
+
+  // streams from a non random access range
+  std::list<double> stream(latencies.begin(), latencies.end());
+  auto top = mr::top_k(stream, 200);
+  ASSERT_EQ(top.size(), 200u);
+  for (std::size_t i = 0; i < top.size(); i++) {
+    EXPECT_EQ(top[i], expected[expected.size() - 1 - i]);
+  }
+  EXPECT_EQ(mr::top_k(stream, 0).size(), 0u);
+  EXPECT_EQ(mr::top_k(std::vector<int> {3, 1, 2}, 10).size(), 3u);
+
+  auto lowest = mr::top_k(latencies, 5, std::greater<>{});
+  for (std::size_t i = 0; i < lowest.size(); i++) {
+    EXPECT_EQ(lowest[i], expected[i]);
+  }
+  auto largest_keys = mr::top_k(std::vector<SortRecord> {{1, 0}, {9, 1}, {4, 2}}, 2, std::less<>{}, &SortRecord::key);
+  EXPECT_EQ(largest_keys[0].order, 1);
+  EXPECT_EQ(largest_keys[1].order, 2);
+}
+
+// McIlroy's antiqsort: keys are fixed lazily as the algorithm compares them, so that
+// its pivots keep landing at the edges; this drives a quickselect without a working
+// fallback quadratic
+struct AntiQsort {
+  std::vector<int> values;
+  int gas, solid = 0, candidate = 0;
+  std::size_t comparisons = 0;
+
+  explicit AntiQsort(int size) : values(size, size), gas(size) {}
+
+  bool operator()(int x, int y) {
+    comparisons++;
+    if (values[x] == gas && values[y] == gas) {
+      values[x == candidate ? x : y] = solid++;
+    }
+    if (values[x] == gas) {
+      candidate = x;
+    } else if (values[y] == gas) {
+      candidate = y;
+    }
+    return values[x] < values[y];
+  }
+};
+
+TEST(SelectTest, AdversarialInputStaysNLogN) {
+  const int size = 20000;
+  const std::size_t bound = 20 * size * std::bit_width(unsigned(size));
+  for (int nth : {size / 2, size - 1}) {
+    AntiQsort adversary(size);
+    std::vector<int> indices(size);
+    std::iota(indices.begin(), indices.end(), 0);
+    mr::nth_element(indices, indices.begin() + nth, [&](int x, int y) { return adversary(x, y); });
+    EXPECT_LT(adversary.comparisons, bound) << nth;
+  }
+  AntiQsort adversary(size);
+  std::vector<int> indices(size);
+  std::iota(indices.begin(), indices.end(), 0);
+  mr::partial_sort(indices, indices.end() - 10, [&](int x, int y) { return adversary(x, y); });
+  EXPECT_LT(adversary.comparisons, bound);
+}
+
+template <std::size_t N>
+static bool network_sorts_all_zero_one_inputs() {
+  for (std::uint32_t bits = 0; bits < (1u << N); bits++) {
+    std::array<int, N> values;
+    for (std::size_t i = 0; i < N; i++) {
+      values[i] = (bits >> i) & 1;
+    }
+    mr::sort_small(values);
+    if (!std::is_sorted(values.begin(), values.end())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, std::size_t N>
+static void check_sort_small(std::mt19937_64 &gen) {
+  for (int round = 0; round < 200; round++) {
+    std::array<T, N> values;
+    for (auto &x : values) {
+      if constexpr (std::is_same_v<T, std::string>) {
+        x = std::to_string(gen() % 100);
+      } else {
+        x = static_cast<T>(static_cast<std::int64_t>(gen() % 200) - 100);
+      }
+    }
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+    mr::sort_small(values);
+    ASSERT_EQ(values, expected) << N;
+  }
+}
+
+TEST(SortingNetworkTest, ZeroOnePrinciple) {
+  // a comparator network sorting every 0/1 input sorts every input
+  EXPECT_TRUE(network_sorts_all_zero_one_inputs<5>());
+  EXPECT_TRUE(network_sorts_all_zero_one_inputs<8>());
+  EXPECT_TRUE(network_sorts_all_zero_one_inputs<13>());
+  EXPECT_TRUE(network_sorts_all_zero_one_inputs<16>());
+}
+
+TEST(SortingNetworkTest, AllSizes) {
+  std::mt19937_64 gen(9);
+  [&gen]<std::size_t ...N>(std::index_sequence<N...>) {
+    (check_sort_small<int, N>(gen), ...);
+    (check_sort_small<double, N>(gen), ...);
+    (check_sort_small<std::int64_t, N>(gen), ...);
+    (check_sort_small<std::uint32_t, N>(gen), ...);
+    (check_sort_small<std::string, N>(gen), ...);
+  }(std::make_index_sequence<33>());
+}
+
+TEST(ThreadPoolTest, NestedTaskGroups) {
+  mr::ThreadPool pool(2);
+  std::atomic<int> sum = 0;
+  {
+    mr::TaskGroup outer(pool);
+    for (int i = 0; i < 16; i++) {
+      outer.run([&pool, &sum] {
+        mr::TaskGroup inner(pool);
+        for (int j = 0; j < 16; j++) {
+          inner.run([&sum] { sum.fetch_add(1); });
+        }
+        inner.wait();
+      });
+    }
+  }
+  EXPECT_EQ(sum.load(), 256);
+
+  // a pool without workers runs everything on the waiting thread
+  mr::ThreadPool empty(0);
+  mr::TaskGroup group(empty);
+  group.run([&sum] { sum.fetch_add(1); });
+  group.wait();
+  EXPECT_EQ(sum.load(), 257);
+}
+
+TEST(VectorAllocatorTest, ArenaBacked) {
+  mr::MonotonicArena arena(256);
+  mr::Vector<int, mr::ArenaAllocator<int>> vec {mr::ArenaAllocator<int>(arena)};
+  for (int i = 0; i < 1000; i++) {
+    vec.emplace_back(i);
+  }
+  ASSERT_EQ(vec.size(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(vec[i], i);
+  }
+  EXPECT_EQ(vec.get_allocator(), mr::ArenaAllocator<int>(arena));
+}
+
+TEST(VectorAllocatorTest, ArenaReset) {
+  mr::MonotonicArena arena;
+  auto *first = arena.allocate(64, alignof(int));
+  arena.reset();
+  auto *second = arena.allocate(64, alignof(int));
+  EXPECT_EQ(first, second); // newest block is reused after reset
+
+  // most recent allocation is rolled back
+  arena.deallocate(second, 64);
+  EXPECT_EQ(arena.allocate(16, alignof(int)), second);
+}
+
+TEST(VectorAllocatorTest, PoolBacked) {
+  mr::FixedPool pool(64 * sizeof(int), 4);
+  {
+    mr::Vector<int, mr::PoolAllocator<int>> vec {mr::PoolAllocator<int>(pool)};
+    for (int i = 0; i < 100; i++) { // spills to heap past 64 elements
+      vec.emplace_back(i);
+    }
+    ASSERT_EQ(vec.size(), 100);
+    for (int i = 0; i < 100; i++) {
+      EXPECT_EQ(vec[i], i);
+    }
+  }
+
+  // blocks are handed out again in LIFO order
+  void *block = pool.allocate(pool.block_size(), alignof(int));
+  ASSERT_NE(block, nullptr);
+  pool.deallocate(block, pool.block_size());
+  EXPECT_EQ(pool.allocate(sizeof(int), alignof(int)), block);
+  pool.deallocate(block, sizeof(int));
+}
+
+TEST(VectorGrowthTest, HeapReallocateToZero) {
+  mr::HeapAllocator<int> alloc;
+  int *ptr = alloc.allocate(4);
+  ASSERT_NE(ptr, nullptr);
+  // nullptr means failure with ptr still owned, so shrinking to 0 keeps a live block
+  int *shrunk = alloc.reallocate(ptr, 4, 0);
+  ASSERT_NE(shrunk, nullptr);
+  alloc.deallocate(shrunk, 0);
+}
+
+TEST(VectorGrowthTest, ArenaGrowsInPlace) {
+  mr::MonotonicArena arena;
+  mr::Vector<int, mr::ArenaAllocator<int>> vec {mr::ArenaAllocator<int>(arena)};
+  vec.emplace_back(0);
+  const int *first = vec.data();
+  for (int i = 1; i < 1000; i++) {
+    vec.emplace_back(i);
+  }
+  EXPECT_EQ(vec.data(), first);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(vec[i], i);
+  }
+}
+
+TEST(VectorGrowthTest, NonRelocatableElements) {
+  static_assert(!mr::is_trivially_relocatable_v<std::string>);
+  mr::Vector<std::string> vec;
+  for (int i = 0; i < 100; i++) {
+    vec.emplace_back(std::string(32, 'a' + i % 26));
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(vec[i], std::string(32, 'a' + i % 26));
+  }
+}
+
+struct LifetimeCounter {
+  inline static int alive = 0;
+  inline static int constructed = 0;
+
+  int value = 0;
+
+  LifetimeCounter() noexcept { alive++; constructed++; }
+  LifetimeCounter(int v) noexcept : value(v) { alive++; constructed++; }
+  LifetimeCounter(const LifetimeCounter &other) noexcept : value(other.value) { alive++; constructed++; }
+  LifetimeCounter(LifetimeCounter &&other) noexcept : value(other.value) { alive++; constructed++; }
+  LifetimeCounter & operator=(const LifetimeCounter &) noexcept = default;
+  LifetimeCounter & operator=(LifetimeCounter &&) noexcept = default;
+  ~LifetimeCounter() noexcept { alive--; }
+};
+
+TEST(VectorStorageTest, ReserveConstructsNothing) {
+  LifetimeCounter::alive = LifetimeCounter::constructed = 0;
+  {
+    mr::Vector<LifetimeCounter> vec;
+    vec.reserve(1000);
+    EXPECT_GE(vec.capacity(), 1000);
+    EXPECT_EQ(LifetimeCounter::constructed, 0);
+
+    vec.emplace_back(1);
+    vec.emplace_back(2);
+    vec.emplace_back(3);
+    EXPECT_EQ(LifetimeCounter::alive, 3);
+
+    vec.remove(0);
+    EXPECT_EQ(LifetimeCounter::alive, 2);
+    EXPECT_EQ(vec[0].value, 2);
+
+    mr::Vector<LifetimeCounter> copy = vec;
+    EXPECT_EQ(LifetimeCounter::alive, 4);
+
+    copy.clear();
+    EXPECT_EQ(LifetimeCounter::alive, 2);
+
+    vec.resize(1);
+    EXPECT_EQ(LifetimeCounter::alive, 1);
+  }
+  EXPECT_EQ(LifetimeCounter::alive, 0);
+}
+
+TEST(VectorStorageTest, GrowthKeepsLifetimesBalanced) {
+  LifetimeCounter::alive = 0;
+  {
+    mr::Vector<LifetimeCounter> vec;
+    for (int i = 0; i < 100; i++) {
+      vec.emplace_back(i);
+    }
+    EXPECT_EQ(LifetimeCounter::alive, 100);
+    mr::Vector<LifetimeCounter> moved = std::move(vec);
+    EXPECT_EQ(moved.size(), 100);
+    EXPECT_EQ(vec.size(), 0);
+    EXPECT_EQ(moved[99].value, 99);
+  }
+  EXPECT_EQ(LifetimeCounter::alive, 0);
+}
+
+TEST(VectorBulkTest, AppendRange) {
+  std::vector<int> src(100);
+  std::iota(src.begin(), src.end(), 0);
+
+  mr::Vector<int> vec;
+  vec.append_range(src.begin(), src.end());
+  EXPECT_EQ(vec.capacity(), 100); // sized once
+  vec.append_range(src);
+  ASSERT_EQ(vec.size(), 200);
+  for (int i = 0; i < 200; i++) {
+    EXPECT_EQ(vec[i], i % 100);
+  }
+
+  std::list<int> list {1, 2, 3};
+  vec.append_range(list.begin(), list.end());
+  ASSERT_EQ(vec.size(), 203);
+  EXPECT_EQ(vec[202], 3);
+
+  std::istringstream stream("7 8 9");
+  vec.append_range(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+  ASSERT_EQ(vec.size(), 206);
+  EXPECT_EQ(vec[205], 9);
+}
+
+TEST(VectorBulkTest, AppendN) {
+  mr::Vector<std::string> vec;
+  vec.emplace_back("head");
+  vec.append_n(10, std::string("x"));
+  ASSERT_EQ(vec.size(), 11);
+  EXPECT_EQ(vec[0], "head");
+  EXPECT_EQ(vec[10], "x");
+}
+
+TEST(VectorBulkTest, InsertRange) {
+  std::array<int, 3> mid {10, 11, 12};
+
+  mr::Vector<int> vec {0, 1, 2, 3};
+  vec.insert_range(2, mid.begin(), mid.end());
+  mr::Vector<int> expected {0, 1, 10, 11, 12, 2, 3};
+  EXPECT_EQ(vec, expected);
+
+  std::array<std::string, 2> words {"b", "c"};
+  mr::Vector<std::string> strs;
+  strs.emplace_back("a");
+  strs.emplace_back("d");
+  strs.insert_range(1, words.begin(), words.end());
+  ASSERT_EQ(strs.size(), 4);
+  EXPECT_EQ(strs[0], "a");
+  EXPECT_EQ(strs[1], "b");
+  EXPECT_EQ(strs[2], "c");
+  EXPECT_EQ(strs[3], "d");
+}
+
+TEST(VectorBulkTest, SelfRanges) {
+  mr::Vector<int> vec {0, 1, 2, 3};
+  vec.append_range(vec); // reallocates while reading its own elements
+  mr::Vector<int> expected {0, 1, 2, 3, 0, 1, 2, 3};
+  EXPECT_EQ(vec, expected);
+
+  vec.insert_range(1, vec.data() + 5, vec.data() + 7);
+  expected = mr::Vector<int> {0, 1, 2, 1, 2, 3, 0, 1, 2, 3};
+  EXPECT_EQ(vec, expected);
+  // in place: the later elements must be read before the gap opens
+  ASSERT_GE(vec.capacity(), 12);
+  vec.insert_range(std::size_t {0}, vec.data() + 8, vec.data() + 10);
+  expected = mr::Vector<int> {2, 3, 0, 1, 2, 1, 2, 3, 0, 1, 2, 3};
+  EXPECT_EQ(vec, expected);
+
+  mr::Vector<std::string> strs;
+  strs.emplace_back("a");
+  strs.emplace_back("b");
+  strs.emplace_back("c");
+  strs.insert_range(1, strs.data() + 1, strs.data() + 3);
+  ASSERT_EQ(strs.size(), 5);
+  EXPECT_EQ(strs[1], "b");
+  EXPECT_EQ(strs[2], "c");
+  EXPECT_EQ(strs[3], "b");
+  EXPECT_EQ(strs[4], "c");
+  strs.append_range(strs);
+  ASSERT_EQ(strs.size(), 10);
+  EXPECT_EQ(strs[9], "c");
+}
+
+TEST(VectorBulkTest, MoveRangeAppends) {
+  std::array<std::string, 2> src {"x", "y"};
+  mr::Vector<std::string> vec;
+  vec.emplace_back("w");
+  vec.move_range(src.begin(), src.end());
+  ASSERT_EQ(vec.size(), 3);
+  EXPECT_EQ(vec[1], "x");
+  EXPECT_EQ(vec[2], "y");
+}
+
+TEST(VectorEraseTest, EraseIf) {
+  mr::Vector<int> vec {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  vec.erase_if([](int x) { return x % 3 == 0; });
+  mr::Vector<int> expected {1, 2, 4, 5, 7, 8};
+  EXPECT_EQ(vec, expected);
+
+  vec.erase_if([](int) { return false; });
+  EXPECT_EQ(vec, expected);
+}
+
+TEST(VectorEraseTest, RemoveIndices) {
+  mr::Vector<int> vec {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::array<std::size_t, 6> ids {0, 3, 3, 4, 9, 42};
+  vec.remove_indices(ids);
+  mr::Vector<int> expected {1, 2, 5, 6, 7, 8};
+  EXPECT_EQ(vec, expected);
+
+  vec.remove_indices({});
+  EXPECT_EQ(vec, expected);
+}
+
+TEST(VectorEraseTest, SwapRemove) {
+  LifetimeCounter::alive = 0;
+  {
+    mr::Vector<LifetimeCounter> vec;
+    for (int i = 0; i < 5; i++) {
+      vec.emplace_back(i);
+    }
+    vec.swap_remove(1);
+    ASSERT_EQ(vec.size(), 4);
+    EXPECT_EQ(vec[1].value, 4);
+    vec.swap_remove(3);
+    ASSERT_EQ(vec.size(), 3);
+    EXPECT_EQ(vec[2].value, 2);
+    EXPECT_EQ(LifetimeCounter::alive, 3);
+  }
+  EXPECT_EQ(LifetimeCounter::alive, 0);
+}
+
+TEST(AmortizedVectorTest, StaysInline) {
+  mr::AmortizedVector<int, 8> vec;
+  for (int i = 0; i < 8; i++) {
+    vec.emplace_back(i);
+  }
+  EXPECT_FALSE(vec.spilled());
+  EXPECT_EQ(vec.capacity(), 8);
+  auto *self = reinterpret_cast<const std::byte *>(&vec);
+  auto *data = reinterpret_cast<const std::byte *>(vec.data());
+  EXPECT_TRUE(data >= self && data < self + sizeof(vec));
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(vec[i], i);
+  }
+}
+
+TEST(AmortizedVectorTest, SpillsOnOverflow) {
+  mr::AmortizedVector<int, 4> vec {5, 3, 1};
+  vec.emplace_back(4);
+  EXPECT_FALSE(vec.spilled());
+  vec.emplace_back(2);
+  EXPECT_TRUE(vec.spilled());
+  ASSERT_EQ(vec.size(), 5);
+
+  EXPECT_TRUE(mr::contains(vec, [](int x) { return x == 2; }));
+  std::sort(begin(vec), end(vec));
+  mr::AmortizedVector<int, 4> expected {1, 2, 3, 4, 5};
+  EXPECT_EQ(vec, expected);
+
+  vec.remove(0);
+  EXPECT_EQ(vec[0], 2);
+  EXPECT_EQ(vec.size(), 4);
+}
+
+TEST(AmortizedVectorTest, CopyAndMove) {
+  LifetimeCounter::alive = 0;
+  {
+    mr::AmortizedVector<LifetimeCounter, 2> small;
+    small.emplace_back(1);
+    mr::AmortizedVector<LifetimeCounter, 2> big;
+    for (int i = 0; i < 5; i++) {
+      big.emplace_back(i);
+    }
+    EXPECT_EQ(LifetimeCounter::alive, 6);
+
+    auto small_copy = small;
+    auto big_copy = big;
+    EXPECT_EQ(LifetimeCounter::alive, 12);
+    EXPECT_EQ(big_copy[4].value, 4);
+
+    auto small_moved = std::move(small_copy);
+    auto big_moved = std::move(big_copy);
+    EXPECT_EQ(small_moved[0].value, 1);
+    EXPECT_EQ(big_moved.size(), 5);
+    EXPECT_TRUE(small_copy.empty());
+    EXPECT_TRUE(big_copy.empty());
+
+    small_moved = big_moved;
+    EXPECT_EQ(small_moved.size(), 5);
+    EXPECT_EQ(LifetimeCounter::alive, 16);
+  }
+  EXPECT_EQ(LifetimeCounter::alive, 0);
+}
+
+TEST(AmortizedVectorTest, PushSorted) {
+  mr::AmortizedVector<int, 2> vec;
+  for (int x : {4, 1, 3, 2}) {
+    vec.push_sorted(x);
+  }
+  mr::AmortizedVector<int, 2> expected {1, 2, 3, 4};
+  EXPECT_EQ(vec, expected);
+}
+
+TEST(SegmentedVectorTest, StableAddresses) {
+  mr::SegmentedVector<int> vec;
+  vec.emplace_back(0);
+  const int *first = &vec[0];
+  const std::size_t count = 10 * mr::SegmentedVector<int>::first_block_size;
+  for (std::size_t i = 1; i < count; i++) {
+    vec.emplace_back(static_cast<int>(i));
+  }
+  EXPECT_EQ(&vec[0], first);
+  ASSERT_EQ(vec.size(), count);
+  EXPECT_GE(vec.capacity(), count);
+  for (std::size_t i = 0; i < count; i++) {
+    EXPECT_EQ(vec[i], static_cast<int>(i));
+  }
+
+  std::size_t seen = 0;
+  vec.for_each_segment([&seen](std::span<const int> segment) {
+    for (int x : segment) {
+      EXPECT_EQ(x, static_cast<int>(seen++));
+    }
+  });
+  EXPECT_EQ(seen, count);
+}
+
+TEST(SegmentedVectorTest, RangeAlgorithms) {
+  mr::SegmentedVector<int> vec;
+  for (int i = 0; i < 1000; i++) {
+    vec.emplace_back((i * 7919) % 1000);
+  }
+  EXPECT_TRUE(mr::contains(vec, [](int x) { return x == 999; }));
+  EXPECT_FALSE(mr::contains(vec, [](int x) { return x == 1000; }));
+
+  mr::sort(vec);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(vec[i], i);
+  }
+
+  // mutable iterators convert to const ones and compare with them
+  const auto &cvec = vec;
+  mr::SegmentedVector<int>::const_iterator it = begin(vec);
+  EXPECT_EQ(it, begin(cvec));
+  EXPECT_TRUE(end(vec) == end(cvec));
+  EXPECT_EQ(end(cvec) - begin(vec), 1000);
+  static_assert(!std::is_convertible_v<mr::SegmentedVector<int>::const_iterator, mr::SegmentedVector<int>::iterator>);
+}
+
+TEST(SegmentedVectorTest, Lifetimes) {
+  LifetimeCounter::alive = 0;
+  {
+    mr::SegmentedVector<LifetimeCounter> vec;
+    for (int i = 0; i < 300; i++) {
+      vec.emplace_back(i);
+    }
+    auto copy = vec;
+    EXPECT_EQ(LifetimeCounter::alive, 600);
+    EXPECT_EQ(copy[299].value, 299);
+
+    auto moved = std::move(copy);
+    EXPECT_TRUE(copy.empty());
+    moved.pop_back();
+    EXPECT_EQ(LifetimeCounter::alive, 599);
+    vec.clear();
+    EXPECT_EQ(LifetimeCounter::alive, 299);
+  }
+  EXPECT_EQ(LifetimeCounter::alive, 0);
+}
+
+template <typename T>
+void check_search_kernels() {
+  // long enough to cover full vector iterations and a scalar tail
+  for (std::size_t len : {0, 1, 7, 31, 64, 100, 257}) {
+    mr::Vector<T> vec;
+    for (std::size_t i = 0; i < len; i++) {
+      vec.emplace_back(static_cast<T>(i % 50));
+    }
+    for (T needle : {T(0), T(13), T(49), T(77)}) {
+      EXPECT_EQ(mr::find(vec, needle) - begin(vec),
+                std::find(begin(vec), end(vec), needle) - begin(vec));
+      EXPECT_EQ(mr::count(vec, needle),
+                static_cast<std::size_t>(std::count(begin(vec), end(vec), needle)));
+      EXPECT_EQ(mr::contains(vec, needle), std::find(begin(vec), end(vec), needle) != end(vec));
+    }
+
+    mr::Vector<T> other = vec;
+    EXPECT_TRUE(mr::equal(vec, other));
+    EXPECT_FALSE(mr::lexicographical_compare(vec, other));
+    for (std::size_t i = 0; i < len; i += 13) {
+      other[i] = static_cast<T>(other[i] + 1);
+      EXPECT_EQ(mr::mismatch(vec, other), i);
+      EXPECT_FALSE(mr::equal(vec, other));
+      EXPECT_TRUE(mr::lexicographical_compare(vec, other));
+      EXPECT_FALSE(mr::lexicographical_compare(other, vec));
+      other[i] = vec[i];
+    }
+  }
+}
+
+TEST(SearchTest, Kernels) {
+  check_search_kernels<char>();
+  check_search_kernels<std::uint16_t>();
+  check_search_kernels<int>();
+  check_search_kernels<std::int64_t>();
+}
+
+TEST(SearchTest, GenericRanges) {
+  std::list<std::string> words {"a", "b", "c"};
+  EXPECT_TRUE(mr::contains(words, std::string("b")));
+  EXPECT_EQ(mr::count(words, std::string("d")), 0);
+
+  mr::Vector<std::string> lhs, rhs;
+  lhs.emplace_back("x");
+  rhs.emplace_back("y");
+  EXPECT_TRUE(lhs < rhs);
+  EXPECT_FALSE(lhs == rhs);
+
+  // negative values order by value, not by bytes
+  mr::Vector<int> neg {-1}, pos {1};
+  EXPECT_TRUE(neg < pos);
+}
+
+// chi-square statistic of the low and the high 10 bits of the hashes over 1024 buckets
+static std::pair<double, double> hash_chi_square(const std::vector<std::uint64_t> &hashes) {
+  std::vector<double> low(1024), high(1024);
+  for (auto hash : hashes) {
+    low[hash & 1023]++;
+    high[hash >> 54]++;
+  }
+  const double expected = static_cast<double>(hashes.size()) / 1024;
+  auto chi = [&](const std::vector<double> &buckets) {
+    return std::accumulate(buckets.begin(), buckets.end(), 0.0,
+      [&](double sum, double count) { return sum + (count - expected) * (count - expected) / expected; });
+  };
+  return {chi(low), chi(high)};
+}
+
+TEST(StringHashTest, CollisionDistribution) {
+  mr::String<>::Hash hash;
+  std::vector<std::uint64_t> sequential, single_bit;
+  for (int i = 0; i < 200000; i++) {
+    sequential.push_back(hash(std::string_view("user:" + std::to_string(i))));
+  }
+  // keys differing in exactly one bit
+  std::string base(40, 'x');
+  for (std::size_t bit = 0; bit < base.size() * 8; bit++) {
+    std::string key = base;
+    key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+    single_bit.push_back(hash(std::string_view(key)));
+  }
+
+  for (auto *hashes : {&sequential, &single_bit}) {
+    auto sorted = *hashes;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(std::adjacent_find(sorted.begin(), sorted.end()), sorted.end());
+  }
+  // 1023 degrees of freedom: mean 1023, standard deviation 45
+  auto [low, high] = hash_chi_square(sequential);
+  EXPECT_LT(low, 1300);
+  EXPECT_LT(high, 1300);
+
+  // flipping one input bit flips half of the output bits on average
+  double flipped = 0;
+  for (auto h : single_bit) {
+    flipped += std::popcount(h ^ hash(std::string_view(base)));
+  }
+  flipped /= single_bit.size();
+  EXPECT_GT(flipped, 30);
+  EXPECT_LT(flipped, 34);
+}
+
+TEST(StringHashTest, SeedsAndTransparency) {
+  static_assert(mr::hash_bytes("constant", 8) != mr::hash_bytes("constant", 8, 1));
+  constexpr auto at_compile_time = mr::hash_bytes("evaluated at compile time and run time", 38, 42);
+  const std::string runtime = "evaluated at compile time and run time";
+  EXPECT_EQ(mr::hash_bytes(runtime.data(), runtime.size(), 42), at_compile_time);
+
+  mr::String<> str("hashed");
+  mr::String<>::Hash hash, seeded {12345};
+  EXPECT_EQ(hash(str), hash(std::string_view("hashed")));
+  EXPECT_EQ(hash(str), hash("hashed"));
+  EXPECT_NE(hash(str), seeded(str));
+  EXPECT_EQ(seeded(str), seeded(mr::StringView<>(str)));
+
+  int differing = 0;
+  for (int i = 0; i < 1000; i++) {
+    const std::string key = std::to_string(i);
+    differing += (hash(std::string_view(key)) & 1023) != (seeded(std::string_view(key)) & 1023);
+  }
+  EXPECT_GT(differing, 950);
+
+  // String keys pick up String::Hash without naming it
+  mr::StaticHashmap<mr::String<>, int> map;
+  for (int i = 0; i < 900; i++) {
+    map.emplace(mr::String<>(std::to_string(i).c_str()), i);
+  }
+  EXPECT_EQ(map.find(mr::String<>("512")), 512);
+  mr::HashMap<mr::String<>, int> growable;
+  growable.try_emplace(mr::String<>("key"), 1);
+  EXPECT_EQ(*growable.find("key"), 1);
+}
+
+TEST(StaticHashmapTest, InsertFindOverwrite) {
+  mr::StaticHashmap<int, int> map;
+  for (int i = 0; i < 1000; i++) {
+    map.emplace(i * 1024, i);
+  }
+  EXPECT_EQ(map.size(), 1000u);
+  map.emplace(5 * 1024, -5);
+  EXPECT_EQ(map.size(), 1000u);
+  EXPECT_EQ(map.find(5 * 1024), -5);
+  EXPECT_EQ(map.find(999 * 1024), 999);
+  EXPECT_EQ(map.find(3), std::nullopt);
+  EXPECT_FALSE(map.contains(1000 * 1024));
+}
+
+TEST(StaticHashmapTest, FullTable) {
+  auto map = std::make_unique<mr::StaticHashmap<std::string, std::string>>();
+  for (std::size_t i = 0; i < map->length + 10; i++) {
+    map->emplace(std::to_string(i), std::string(40, 'a' + i % 26));
+  }
+  EXPECT_TRUE(map->full());
+  EXPECT_EQ(map->size(), map->length);
+  // lookups of missing keys terminate on a full table
+  EXPECT_FALSE(map->contains("missing"));
+  EXPECT_FALSE(map->contains(std::to_string(map->length)));
+  map->emplace("7", "seven");
+  EXPECT_EQ(map->find("7"), "seven");
+
+  auto copy = std::make_unique<mr::StaticHashmap<std::string, std::string>>(*map);
+  copy->emplace("7", "sieben");
+  EXPECT_EQ(map->find("7"), "seven");
+  *map = std::move(*copy);
+  EXPECT_EQ(map->find("7"), "sieben");
+  EXPECT_EQ(copy->size(), 0u);
+  EXPECT_EQ(copy->find("7"), std::nullopt);
+}
+
+TEST(PerfectHashMapTest, CompileTimeLookup) {
+  static constexpr mr::PerfectHashMap keywords(std::array {
+    std::pair {std::string_view("if"), 1}, std::pair {std::string_view("else"), 2},
+    std::pair {std::string_view("while"), 3}, std::pair {std::string_view("for"), 4},
+    std::pair {std::string_view("return"), 5}, std::pair {std::string_view(""), 6},
+  });
+  static_assert(*keywords.find("while") == 3);
+  static_assert(*keywords.find("") == 6);
+  static_assert(!keywords.contains("whil"));
+  static_assert(keywords.size() == 6);
+  static_assert(keywords.valid());
+
+  // heterogeneous run time lookups hash like the std::string_view keys
+  EXPECT_EQ(*keywords.find(std::string("return")), 5);
+  EXPECT_EQ(*keywords.find(mr::String<>("for")), 4);
+  EXPECT_EQ(keywords.find("do"), nullptr);
+  int sum = 0;
+  for (const auto &[key, value] : keywords) {
+    sum += *keywords.find(key) == value;
+  }
+  EXPECT_EQ(sum, 6);
+
+  static constexpr mr::PerfectHashMap<int, int, 0> empty(std::array<std::pair<int, int>, 0> {});
+  static_assert(!empty.contains(0));
+  static_assert(empty.valid());
+
+  // duplicate keys fail at run time: the map reports it and every lookup misses
+  const mr::PerfectHashMap duplicates(std::array {std::pair {1, 1}, std::pair {2, 2}, std::pair {1, 3}});
+  EXPECT_FALSE(duplicates.valid());
+  EXPECT_FALSE(duplicates.contains(2));
+}
+
+TEST(PerfectHashMapTest, ThousandsOfIntegerKeys) {
+  static constexpr auto entries = [] {
+    std::array<std::pair<std::uint32_t, std::uint32_t>, 2000> entries {};
+    for (std::uint32_t i = 0; i < entries.size(); i++) {
+      // all keys share their low 10 bits
+      entries[i] = {i << 10 | 0x155, i};
+    }
+    return entries;
+  }();
+  static constexpr mr::PerfectHashMap map(entries);
+  static_assert(map.valid());
+  static_assert(*map.find(1999u << 10 | 0x155) == 1999);
+
+  for (std::uint32_t i = 0; i < 2000; i++) {
+    ASSERT_NE(map.find(i << 10 | 0x155), nullptr);
+    EXPECT_EQ(*map.find(i << 10 | 0x155), i);
+  }
+  for (std::uint32_t i = 0; i < 100000; i++) {
+    EXPECT_FALSE(map.contains(i << 10));
+  }
+}
+
+TEST(HashMapTest, MatchesUnorderedMap) {
+  std::mt19937_64 gen(12);
+  mr::HashMap<std::uint64_t, int> map;
+  std::unordered_map<std::uint64_t, int> expected;
+  // small key space, so inserts, overwrites and erases keep hitting the same clusters
+  for (int i = 0; i < 200000; i++) {
+    const std::uint64_t key = gen() % 5000;
+    switch (gen() % 4) {
+      case 0:
+      case 1:
+        map.emplace(key, i);
+        expected[key] = i;
+        break;
+      case 2:
+        ASSERT_EQ(map.erase(key), expected.erase(key) == 1);
+        break;
+      default: {
+        const int *value = map.find(key);
+        auto it = expected.find(key);
+        ASSERT_EQ(value != nullptr, it != expected.end());
+        if (value != nullptr) {
+          ASSERT_EQ(*value, it->second);
+        }
+      }
+    }
+    ASSERT_EQ(map.size(), expected.size());
+  }
+
+  std::size_t visited = 0;
+  for (const auto &[key, value] : map) {
+    EXPECT_EQ(expected.at(key), value);
+    visited++;
+  }
+  EXPECT_EQ(visited, expected.size());
+  EXPECT_LE(map.load_factor(), 0.875f);
+}
+
+TEST(HashMapTest, GrowthAndErase) {
+  mr::HashMap<int, int> map;
+  EXPECT_EQ(map.find(1), nullptr);
+  EXPECT_FALSE(map.erase(1));
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_NE(map.try_emplace(i, i * 2), nullptr);
+  }
+  EXPECT_EQ(map.size(), 100000u);
+  EXPECT_EQ(*map.try_emplace(7, -1), 14);
+
+  for (int i = 0; i < 100000; i += 2) {
+    ASSERT_TRUE(map.erase(i));
+  }
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_EQ(map.contains(i), i % 2 == 1) << i;
+  }
+
+  // erase leaves no tombstones behind, so refilling never rehashes
+  const std::size_t capacity = map.capacity();
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 100000; i += 2) {
+      map.try_emplace(i, round);
+    }
+    for (int i = 0; i < 100000; i += 2) {
+      map.erase(i);
+    }
+  }
+  EXPECT_EQ(map.capacity(), capacity);
+  EXPECT_EQ(map.size(), 50000u);
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+  map.reserve(1000);
+  EXPECT_GE(map.capacity() * 7 / 8, 1000u);
+}
+
+struct StringHash {
+  using is_transparent = void;
+  std::size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>{}(str); }
+};
+
+TEST(HashMapTest, HeterogeneousLookupAndCopies) {
+  mr::HashMap<std::string, std::vector<int>, StringHash> map;
+  for (int i = 0; i < 1000; i++) {
+    map.try_emplace(std::to_string(i))->push_back(i);
+  }
+  map.try_emplace(std::string_view("42"))->push_back(-42);
+
+  const char *key = "42";
+  ASSERT_NE(map.find(key), nullptr);
+  EXPECT_EQ(*map.find(std::string_view(key)), (std::vector<int> {42, -42}));
+  EXPECT_FALSE(map.contains("1000"));
+
+  auto copy = map;
+  EXPECT_TRUE(copy.erase("42"));
+  EXPECT_TRUE(map.contains("42"));
+  EXPECT_EQ(copy.size(), 999u);
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(copy.size(), 0u);
+  EXPECT_EQ(copy.find("1"), nullptr);
+  EXPECT_EQ(*moved.find("999"), std::vector<int> {999});
+  map = std::move(moved);
+  EXPECT_EQ(map.size(), 999u);
+}
+
+TEST(ConcurrentHashMapTest, MatchesUnorderedMap) {
+  mr::ConcurrentHashMap<int, int, std::hash<int>, std::equal_to<>, 4> map;
+  std::unordered_map<int, int> expected;
+  std::mt19937 gen(5);
+  for (int i = 0; i < 100000; i++) {
+    const int key = static_cast<int>(gen() % 3000);
+    if (gen() % 3 == 0) {
+      ASSERT_EQ(map.erase(key), expected.erase(key) == 1);
+    } else {
+      map.emplace(key, i);
+      expected[key] = i;
+    }
+  }
+  EXPECT_EQ(map.size(), expected.size());
+  for (int key = 0; key < 3000; key++) {
+    auto it = expected.find(key);
+    ASSERT_EQ(map.find(key), it == expected.end() ? std::nullopt : std::optional(it->second));
+  }
+}
+
+TEST(ConcurrentHashMapTest, ReadersDuringWrites) {
+  mr::ConcurrentHashMap<std::uint64_t, std::uint64_t> map;
+  std::atomic<bool> done = false;
+  std::atomic<bool> consistent = true;
+
+  // every writer owns the keys equal to its id modulo 2, values are always key * 3
+  std::vector<std::thread> threads;
+  for (std::uint64_t id = 0; id < 2; id++) {
+    threads.emplace_back([&map, id] {
+      std::mt19937_64 gen(id);
+      for (int i = 0; i < 50000; i++) {
+        const std::uint64_t key = (gen() % 10000) * 2 + id;
+        if (gen() % 3 == 0) {
+          map.erase(key);
+        } else {
+          map.emplace(key, key * 3);
+        }
+      }
+    });
+  }
+  for (int reader = 0; reader < 2; reader++) {
+    threads.emplace_back([&, reader] {
+      std::mt19937_64 gen(reader);
+      while (!done.load()) {
+        const std::uint64_t key = gen() % 20000;
+        if (auto value = map.find(key); value.has_value() && *value != key * 3) {
+          consistent = false;
+        }
+      }
+    });
+  }
+  threads[0].join();
+  threads[1].join();
+  done = true;
+  threads[2].join();
+  threads[3].join();
+
+  EXPECT_TRUE(consistent.load());
+  std::size_t found = 0;
+  for (std::uint64_t key = 0; key < 20000; key++) {
+    found += map.contains(key);
+  }
+  EXPECT_EQ(found, map.size());
+}
+
 TEST(GraphTest, AddNodesAndEdges) {
     mr::Graph<int> graph;
     graph.add_node(0);
@@ -202,6 +1478,359 @@ TEST(GraphTest, LargeGraph) {
     }
 }
 
+// layers of 4 nodes, each node linked to all of the next layer: 4^depth distinct paths
+static mr::Graph<int> make_layered_graph(int layers) {
+    mr::Graph<int> graph;
+    for (int i = 0; i < layers * 4; ++i) {
+        graph.add_node(i);
+    }
+    for (int layer = 0; layer + 1 < layers; ++layer) {
+        for (int from = 0; from < 4; ++from) {
+            for (int to = 0; to < 4; ++to) {
+                graph.add_edge(layer * 4 + from, (layer + 1) * 4 + to);
+            }
+        }
+    }
+    return graph;
+}
+
+TEST(GraphTest, ConvergingPathsAndScratchReuse) {
+    const auto graph = make_layered_graph(64);
+    const auto reversed = graph.transposed();
+    mr::PathScratch<> scratch;
+    for (int query = 0; query < 100; ++query) {
+        const int src = query % 8, dest = 255 - query % 4;
+        auto path = graph.find_path(src, dest, scratch);
+        ASSERT_TRUE(path.has_value());
+        EXPECT_EQ(path->size(), 64u - src / 4);
+        EXPECT_EQ((*path)[0], src);
+        EXPECT_EQ((*path)[path->size() - 1], dest);
+
+        auto both = graph.find_path_bidirectional(src, dest, reversed, scratch);
+        ASSERT_TRUE(both.has_value());
+        EXPECT_EQ(both->size(), path->size());
+        EXPECT_EQ((*both)[0], src);
+        EXPECT_EQ((*both)[both->size() - 1], dest);
+    }
+    EXPECT_FALSE(graph.find_path(255, 0, scratch).has_value());
+    EXPECT_FALSE(graph.find_path_bidirectional(255, 0, reversed, scratch).has_value());
+    EXPECT_FALSE(graph.find_path(0, 1000, scratch).has_value());
+}
+
+TEST(GraphTest, WeightedShortestPath) {
+    mr::Graph<int> graph;
+    for (int i = 0; i < 5; ++i) {
+        graph.add_node(i * 10);
+    }
+    graph.add_edge(0, 1).add_edge(1, 4).add_edge(0, 2).add_edge(2, 3).add_edge(3, 4);
+    // the direct hop 1 -> 4 costs more than the detour through 2 and 3
+    auto weight = [](std::size_t from, std::size_t to) -> int { return from == 1 && to == 4 ? 10 : 2; };
+    mr::PathScratch<int> scratch;
+    auto path = graph.find_path_weighted(0, 4, weight, scratch);
+    ASSERT_TRUE(path.has_value());
+    ASSERT_EQ(path->size(), 4u);
+    EXPECT_EQ((*path)[1], 20);
+    EXPECT_EQ((*path)[2], 30);
+    EXPECT_EQ(scratch.distance(4), 6);
+
+    auto unweighted = graph.find_path(0, 4);
+    ASSERT_TRUE(unweighted.has_value());
+    EXPECT_EQ(unweighted->size(), 3u);
+    EXPECT_FALSE(graph.find_path_weighted(4, 0, weight).has_value());
+
+    // weights read by reference from a table indexed by source node
+    const double costs[] = {1.5, 9.0, 1.5, 1.5, 0.0};
+    auto by_ref = [&](std::size_t from, std::size_t) -> const double & { return costs[from]; };
+    auto cheap = graph.find_path_weighted(0, 4, by_ref);
+    ASSERT_TRUE(cheap.has_value());
+    EXPECT_EQ(cheap->size(), 4u);
+}
+
+TEST(GraphTest, FromEdgesMatchesAddEdge) {
+    std::mt19937_64 rng(9);
+    const std::size_t num_nodes = 200;
+    mr::Graph<int> incremental;
+    mr::GraphBuilder<int> builder;
+    builder.reserve(num_nodes, 2000);
+    for (std::size_t i = 0; i < num_nodes; ++i) {
+        incremental.add_node(i);
+        builder.add_node(i);
+    }
+    // repeated and out of range edges included
+    for (int i = 0; i < 2000; ++i) {
+        const std::size_t src = rng() % (num_nodes + 5), dest = rng() % (num_nodes + 5);
+        incremental.add_edge(src, dest);
+        builder.add_edge(src, dest);
+    }
+    EXPECT_EQ(builder.edge_count(), 2000u);
+    const auto bulk = builder.build();
+    EXPECT_EQ(builder.node_count(), 0u);
+    ASSERT_EQ(bulk.nodes().size(), num_nodes);
+    for (std::size_t node = 0; node < num_nodes; ++node) {
+        const auto expected = *incremental.node_children(node);
+        const auto children = *bulk.node_children(node);
+        EXPECT_TRUE(std::equal(children.begin(), children.end(), expected.begin(), expected.end()));
+    }
+    EXPECT_FALSE(bulk.node_children(num_nodes).has_value());
+
+    auto path = bulk.find_path(0, 1);
+    EXPECT_EQ(path.has_value(), incremental.find_path(0, 1).has_value());
+}
+
+TEST(GraphTest, ParallelFromEdges) {
+    std::mt19937_64 rng(4);
+    const std::size_t num_nodes = 20000;
+    std::vector<mr::Graph<int>::Edge> edges;
+    // node 7 is a hub with thousands of repeated edges
+    for (int i = 0; i < 300000; ++i) {
+        edges.emplace_back(i % 10 == 0 ? 7 : rng() % (num_nodes + 10), rng() % 1000);
+    }
+    mr::Vector<int> nodes;
+    for (std::size_t i = 0; i < num_nodes; ++i) {
+        nodes.emplace_back(i);
+    }
+    mr::ThreadPool pool(3);
+    const auto serial = mr::Graph<int>::from_edges(nodes, edges);
+    const auto parallel = mr::Graph<int>::from_edges(mr::par.on(pool), nodes, edges);
+    EXPECT_EQ(serial.node_children(7)->size(), 1000u);
+    for (std::size_t node = 0; node < num_nodes; ++node) {
+        const auto expected = *serial.node_children(node);
+        const auto children = *parallel.node_children(node);
+        ASSERT_TRUE(std::equal(children.begin(), children.end(), expected.begin(), expected.end()));
+    }
+}
+
+TEST(GraphTest, EdgePropertyColumn) {
+    mr::Graph<int, int> graph;
+    for (int i = 0; i < 3; ++i) {
+        graph.add_node(i);
+    }
+    graph.add_edge(0, 2, 20);
+    graph.add_edge(0, 1, 10);
+    graph.add_edge(0, 2, 99); // repeated edge keeps its first weight
+    graph.add_edge(1, 2, 12);
+
+    const auto children = *graph.node_children(std::size_t {0});
+    ASSERT_EQ(children.size(), 2);
+    EXPECT_EQ(children[0].first, 2);
+    EXPECT_EQ(children[0].second, 20);
+    int sum = 0;
+    for (auto [dest, weight] : children) {
+        sum += dest * weight;
+    }
+    EXPECT_EQ(sum, 2 * 20 + 1 * 10);
+
+    const mr::Graph<int, int>::Edge edges[] = {{0, 2}, {0, 1}, {0, 2}, {1, 2}};
+    const int weights[] = {20, 10, 99, 12};
+    const auto built = mr::Graph<int, int>::from_edges(graph.nodes(), edges, weights);
+    const auto transposed = graph.transposed();
+    for (std::size_t node = 0; node < 3; ++node) {
+        const auto expected = *graph.node_children(node);
+        const auto actual = *built.node_children(node);
+        ASSERT_TRUE(std::ranges::equal(actual.destinations(), expected.destinations()));
+        ASSERT_TRUE(std::ranges::equal(actual.properties(), expected.properties()));
+        for (auto [dest, weight] : expected) {
+            const auto back = *transposed.node_children(dest);
+            const auto it = std::ranges::find(back.destinations(), node);
+            ASSERT_NE(it, back.destinations().end());
+            EXPECT_EQ(back.properties()[it - back.destinations().begin()], weight);
+        }
+    }
+}
+
+TEST(GraphTest, WeightedPathOverPropertyColumn) {
+    struct Road {
+        int minutes;
+        int tolls;
+    };
+    std::mt19937_64 rng(6);
+    mr::GraphBuilder<int, Road> builder;
+    mr::Vector<mr::Graph<int, Road>::Edge> edges;
+    mr::Vector<Road> roads;
+    for (int i = 0; i < 2000; ++i) {
+        builder.add_node(i);
+    }
+    for (int i = 0; i < 200000; ++i) {
+        const std::size_t src = i % 5 == 0 ? 3 : rng() % 2000, dest = rng() % 2000;
+        const Road road {static_cast<int>(rng() % 100), static_cast<int>(rng() % 3)};
+        builder.add_edge(src, dest, road);
+        edges.emplace_back(src, dest);
+        roads.emplace_back(road);
+    }
+    const auto graph = builder.build();
+    mr::ThreadPool pool(3);
+    const auto parallel = mr::Graph<int, Road>::from_edges(mr::par.on(pool), graph.nodes(), {edges.data(), edges.size()},
+                                                           {roads.data(), roads.size()});
+    for (std::size_t node = 0; node < 2000; ++node) {
+        const auto expected = *graph.node_children(node);
+        const auto actual = *parallel.node_children(node);
+        ASSERT_TRUE(std::ranges::equal(actual.destinations(), expected.destinations()));
+        ASSERT_TRUE(std::ranges::equal(actual.properties(), expected.properties(),
+                                       [](const Road &a, const Road &b) { return a.minutes == b.minutes && a.tolls == b.tolls; }));
+    }
+
+    // the column and an equivalent side lookup give the same shortest distance
+    auto cost = [](const Road &road) { return road.minutes + 50 * road.tolls; };
+    mr::PathScratch<int> column_scratch, lookup_scratch;
+    for (std::size_t dest = 0; dest < 2000; dest += 97) {
+        const auto path = graph.find_path_weighted(3, dest, cost, column_scratch);
+        const auto expected = graph.find_path_weighted(3, dest, [&](std::size_t from, std::size_t to) {
+            const auto children = *graph.node_children(from);
+            const auto it = std::ranges::find(children.destinations(), to);
+            return cost(children.properties()[it - children.destinations().begin()]);
+        }, lookup_scratch);
+        ASSERT_EQ(path.has_value(), expected.has_value());
+        if (path) {
+            EXPECT_EQ(column_scratch.distance(dest), lookup_scratch.distance(dest));
+            EXPECT_EQ((*path)[0], 3);
+        }
+    }
+    EXPECT_TRUE(graph.find_path_weighted(3, 3, &Road::minutes).has_value());
+}
+
+TEST(GraphTest, NodeIndex) {
+    mr::Graph<std::string> graph;
+    for (int i = 0; i < 1000; ++i) {
+        graph.add_node(std::to_string(i % 700)); // later repeats resolve to the first id
+    }
+    const std::string values[] = {"5", "699", "missing", "5", "12"};
+    const auto scanned = graph.find_many(values);
+    EXPECT_FALSE(graph.indexed());
+    graph.index_nodes();
+    const auto indexed = graph.find_many(values);
+    for (std::size_t i = 0; i < std::size(values); ++i) {
+        EXPECT_EQ(scanned[i], indexed[i]);
+        EXPECT_EQ(indexed[i], graph.find(values[i]));
+    }
+    EXPECT_EQ(indexed[1], 699u);
+    EXPECT_FALSE(indexed[2].has_value());
+
+    graph.add_node("new").add_edge(0, 1000);
+    EXPECT_EQ(graph.find("new"), 1000u);
+    EXPECT_EQ(graph.transposed().find("new"), 1000u);
+    ASSERT_TRUE(graph.node_children(std::string("0")).has_value());
+    EXPECT_EQ(graph.node_children(std::string("0"))->size(), 1);
+
+    graph.set_node(0, "renamed"); // "0" is still held by node 700
+    EXPECT_TRUE(graph.indexed());
+    EXPECT_EQ(graph.find("renamed"), 0u);
+    EXPECT_EQ(graph.find("0"), 700u);
+    graph.set_node(5, "0").set_node(699, "unique");
+    EXPECT_EQ(graph.find("0"), 5u);
+    EXPECT_EQ(graph.find("unique"), 699u);
+    EXPECT_FALSE(graph.find("699").has_value());
+    EXPECT_EQ(graph.nodes()[5], "0");
+}
+
+static mr::Graph<int> make_random_graph(std::size_t num_nodes, std::size_t num_edges, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    mr::GraphBuilder<int> builder;
+    for (std::size_t i = 0; i < num_nodes; ++i) {
+        builder.add_node(i);
+    }
+    for (std::size_t i = 0; i < num_edges; ++i) {
+        builder.add_edge(rng() % num_nodes, rng() % num_nodes);
+    }
+    return builder.build();
+}
+
+TEST(GraphTest, ParallelBfsDepths) {
+    mr::ThreadPool pool(3);
+    auto check = [&](const mr::Graph<int> &graph) {
+        const std::size_t num_nodes = graph.nodes().size();
+        std::vector<std::uint32_t> expected(num_nodes, mr::bfs_unreached);
+        std::vector<std::size_t> queue = {0};
+        expected[0] = 0;
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const auto children = *graph.node_children(queue[head]);
+            for (std::size_t child : children) {
+                if (expected[child] == mr::bfs_unreached) {
+                    expected[child] = expected[queue[head]] + 1;
+                    queue.push_back(child);
+                }
+            }
+        }
+        const auto depths = mr::bfs_depths(mr::par.on(pool), graph, graph.transposed(), 0);
+        ASSERT_EQ(depths.size(), num_nodes);
+        for (std::size_t node = 0; node < num_nodes; ++node) {
+            ASSERT_EQ(depths[node], expected[node]);
+        }
+    };
+    // dense enough for bottom-up levels, and sparse with most nodes unreached
+    check(make_random_graph(20000, 320000, 320000));
+    check(make_random_graph(20000, 15000, 15000));
+
+    // two dense blobs joined by a long path: bottom-up, a top-down tail, then bottom-up again
+    std::mt19937_64 rng(12);
+    const std::size_t blob = 20000, path = 40;
+    mr::GraphBuilder<int> builder;
+    for (std::size_t i = 0; i < 2 * blob + path; ++i) {
+        builder.add_node(i);
+    }
+    for (std::size_t i = 0; i < blob * 8; ++i) {
+        builder.add_edge(rng() % blob, rng() % blob);
+        builder.add_edge(blob + path + rng() % blob, blob + path + rng() % blob);
+    }
+    for (std::size_t i = blob - 1; i < blob + path; ++i) {
+        builder.add_edge(i, i + 1);
+    }
+    check(builder.build());
+}
+
+TEST(GraphTest, ParallelConnectedComponents) {
+    mr::ThreadPool pool(3);
+    for (std::size_t num_edges : {15000, 60000}) {
+        const auto graph = make_random_graph(20000, num_edges, num_edges);
+        // union-find, roots are the smallest node of their set
+        std::vector<std::size_t> parent(20000);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto root = [&](std::size_t node) {
+            while (parent[node] != node) {
+                node = parent[node] = parent[parent[node]];
+            }
+            return node;
+        };
+        for (std::size_t node = 0; node < 20000; ++node) {
+            const auto children = *graph.node_children(node);
+            for (std::size_t child : children) {
+                const std::size_t a = root(node), b = root(child);
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+        const auto comp = mr::connected_components(mr::par.on(pool), graph);
+        const auto comp_reversed = mr::connected_components(mr::par.on(pool), graph, graph.transposed());
+        for (std::size_t node = 0; node < 20000; ++node) {
+            ASSERT_EQ(comp[node], root(node));
+            ASSERT_EQ(comp_reversed[node], root(node));
+        }
+    }
+}
+
+TEST(GraphTest, PageRank) {
+    mr::Graph<int> cycle;
+    for (int i = 0; i < 10; ++i) {
+        cycle.add_node(i);
+    }
+    for (int i = 0; i < 10; ++i) {
+        cycle.add_edge(i, (i + 1) % 10).add_edge((i + 1) % 10, i);
+    }
+    for (double rank : mr::pagerank(mr::par, cycle, cycle)) {
+        EXPECT_NEAR(rank, 0.1, 1e-12);
+    }
+
+    const auto graph = make_random_graph(20000, 100000, 9);
+    const auto reversed = graph.transposed();
+    mr::ThreadPool pool(3), single(0);
+    const auto ranks = mr::pagerank(mr::par.on(pool), graph, reversed, 0.85, 100, 1e-10);
+    const auto serial = mr::pagerank(mr::par.on(single), graph, reversed, 0.85, 100, 1e-10);
+    double sum = 0;
+    for (std::size_t node = 0; node < 20000; ++node) {
+        sum += ranks[node];
+        EXPECT_NEAR(ranks[node], serial[node], 1e-12);
+    }
+    EXPECT_NEAR(sum, 1.0, 1e-9);
+}
+
 TEST(DynamicRingBufferTest, DefaultConstructor) {
     mr::DynamicRingBuffer<int> buffer;
     EXPECT_EQ(buffer.size(), 0);